@@ -0,0 +1,43 @@
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "bench_common.h"
+
+static std::atomic<size_t> allocation_count { 0 };
+
+void* operator new(size_t size)
+{
+    ++allocation_count;
+    if ( void* p = std::malloc(size ? size : 1) )
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{ std::free(p); }
+
+void operator delete(void* p, size_t) noexcept
+{ std::free(p); }
+
+size_t bench::allocations()
+{ return allocation_count; }
+
+// usage: bench [substring filter]
+int main(int argc, char** argv)
+{
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+
+    for ( auto& b : bench::registry() )
+    {
+        if ( filter && !std::strstr(b.first, filter) )
+            continue;
+
+        std::printf("%s\n", b.first);
+        b.second();
+    }
+
+    return 0;
+}
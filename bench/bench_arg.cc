@@ -0,0 +1,42 @@
+#include <string>
+#include "bench_common.h"
+
+BENCHMARK( "repeated argument reads" )
+{
+    const size_t iterations = 1000000;
+
+    bench::Vm lua;
+    lua_pushinteger(lua, 1500);
+    lua_pushstring(lua, "tcp");
+    lua_pushnumber(lua, 0.5);
+    lua_pushboolean(lua, 1);
+
+    // a handler that looks at each argument three times
+    bench::measure("3 x 4 args, Ltl::check", iterations, [&]() {
+        double sum = 0;
+        for ( int pass = 0; pass < 3; ++pass )
+        {
+            sum += Ltl::check<int>(lua, 1);
+            sum += Ltl::check<Ltl::StringView>(lua, 2).size();
+            sum += Ltl::check<double>(lua, 3);
+            sum += Ltl::check<bool>(lua, 4);
+        }
+
+        bench::keep(sum);
+    });
+
+    bench::measure("3 x 4 args, Ltl::Arg", iterations, [&]() {
+        Ltl::Arg arg(lua);
+
+        double sum = 0;
+        for ( int pass = 0; pass < 3; ++pass )
+        {
+            sum += arg[1].as<int>();
+            sum += arg[2].as<Ltl::StringView>().size();
+            sum += arg[3].as<double>();
+            sum += arg[4].as<bool>();
+        }
+
+        bench::keep(sum);
+    });
+}
@@ -0,0 +1,110 @@
+#include "bench_common.h"
+
+BENCHMARK( "protected call" )
+{
+    const size_t iterations = 1000000;
+
+    bench::Vm lua(true);
+    luaL_dostring(lua, "function on_event(n, s) return n + #s end");
+    lua_settop(lua, 0);
+
+    lua_getglobal(lua, "on_event");
+    int fn = lua_gettop(lua);
+
+    // the usual hand-written version: fetch debug.traceback as the message
+    // handler on every call
+    bench::measure("traceback lookup + lua_pcall", iterations, [&]() {
+        lua_getglobal(lua, "debug");
+        lua_getfield(lua, -1, "traceback");
+        lua_remove(lua, -2);
+        int handler = lua_gettop(lua);
+
+        lua_pushvalue(lua, fn);
+        lua_pushinteger(lua, 1);
+        lua_pushstring(lua, "event");
+
+        if ( !lua_pcall(lua, 2, 1, handler) )
+            bench::keep(lua_tointeger(lua, -1));
+
+        lua_settop(lua, fn);
+    });
+
+    Ltl::Func on_event(lua, fn);
+
+    bench::measure("Func::pcall<int>", iterations, [&]() {
+        auto r = on_event.pcall<int>(1, "event");
+        bench::keep(r.value);
+    });
+
+    bench::measure("Func::call<int>", iterations, [&]() {
+        bench::keep(on_event.call<int>(1, "event"));
+    });
+}
+
+BENCHMARK( "prepared call site" )
+{
+    const size_t iterations = 1000000;
+
+    bench::Vm lua(true);
+    luaL_dostring(lua, "function classify(proto, port) return port > 1024 end");
+    lua_settop(lua, 0);
+
+    bench::measure("lua_getglobal + lua_pcall", iterations, [&]() {
+        lua_getglobal(lua, "classify");
+        lua_pushstring(lua, "tcp");
+        lua_pushinteger(lua, 8080);
+
+        if ( !lua_pcall(lua, 2, 1, 0) )
+            bench::keep(lua_toboolean(lua, -1));
+
+        lua_settop(lua, 0);
+    });
+
+    lua_getglobal(lua, "classify");
+    Ltl::CallSite<bool(int), Ltl::Checked> checked(Ltl::Func(lua, 1), "tcp");
+    Ltl::CallSite<bool(int), Ltl::Trusted> trusted(Ltl::Func(lua, 1), "tcp");
+    lua_settop(lua, 0);
+
+    bench::measure("CallSite<bool(int)> (Checked)", iterations, [&]() {
+        bench::keep(checked(8080).value);
+    });
+
+    bench::measure("CallSite<bool(int)> (Trusted)", iterations, [&]() {
+        bench::keep(trusted(8080).value);
+    });
+}
+
+BENCHMARK( "batch call" )
+{
+    const size_t iterations = 10000;
+    const size_t batch = 100;
+
+    bench::Vm lua(true);
+    luaL_dostring(lua, "function classify(port) return port > 1024 end");
+    lua_settop(lua, 0);
+
+    std::vector<int> ports;
+    for ( size_t i = 0; i < batch; ++i )
+        ports.push_back(static_cast<int>(i * 97 % 65536));
+
+    std::vector<Ltl::CallResult<bool>> results(batch);
+
+    bench::measure("100 x (lua_getglobal + Func::pcall)", iterations, [&]() {
+        for ( size_t i = 0; i < batch; ++i )
+        {
+            lua_getglobal(lua, "classify");
+            results[i] = Ltl::Func(lua, 1).pcall<bool>(ports[i]);
+            lua_settop(lua, 0);
+        }
+
+        bench::keep(results);
+    });
+
+    lua_getglobal(lua, "classify");
+    Ltl::Func classify(lua, 1);
+
+    bench::measure("call_batch<bool> over 100 ports", iterations, [&]() {
+        Ltl::call_batch<bool>(classify, ports.begin(), ports.end(), results.begin());
+        bench::keep(results);
+    });
+}
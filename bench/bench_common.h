@@ -0,0 +1,86 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <utility>
+#include <vector>
+#include <luajit-2.0/lua.hpp>
+#include <ltl.h>
+
+namespace bench
+{
+
+// number of calls to the global operator new since startup (see bench.cc)
+size_t allocations();
+
+using bench_fn_t = void (*)();
+
+inline std::vector<std::pair<const char*, bench_fn_t>>& registry()
+{
+    static std::vector<std::pair<const char*, bench_fn_t>> benchmarks;
+    return benchmarks;
+}
+
+struct Registrar
+{
+    Registrar(const char* name, bench_fn_t fn)
+    { registry().emplace_back(name, fn); }
+};
+
+// keep the optimizer from discarding benchmarked results
+template<typename T>
+static inline void keep(const T& v)
+{ asm volatile("" : : "g"(&v) : "memory"); }
+
+template<typename F>
+static void measure(const char* label, size_t iterations, F fn)
+{
+    for ( size_t i = 0; i < iterations / 10; ++i )
+        fn();
+
+    size_t allocs = allocations();
+    auto start = std::chrono::steady_clock::now();
+
+    for ( size_t i = 0; i < iterations; ++i )
+        fn();
+
+    auto stop = std::chrono::steady_clock::now();
+    allocs = allocations() - allocs;
+
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+
+    std::printf("  %-44s %10.2f ns/op %8.3f allocs/op\n", label,
+        ns / iterations, double(allocs) / iterations);
+}
+
+class Vm
+{
+public:
+    Vm(bool openlibs = false) : L { luaL_newstate() }
+    {
+        if ( openlibs )
+            luaL_openlibs(L);
+    }
+
+    ~Vm() { lua_close(L); }
+
+    operator lua_State*() { return L; }
+
+private:
+    lua_State* L;
+};
+
+} // namespace bench
+
+#define BENCH_CAT_(a, b) a##b
+#define BENCH_CAT(a, b) BENCH_CAT_(a, b)
+
+#define BENCHMARK(name) \
+    static void BENCH_CAT(bench_fn_, __LINE__)(); \
+    static bench::Registrar BENCH_CAT(bench_reg_, __LINE__) \
+        { name, &BENCH_CAT(bench_fn_, __LINE__) }; \
+    static void BENCH_CAT(bench_fn_, __LINE__)()
+
+#endif
@@ -0,0 +1,43 @@
+#include "bench_common.h"
+
+namespace
+{
+class Conn
+{
+public:
+    static int send(int bytes, int port)
+    { return bytes + port; }
+};
+
+static void call_global(lua_State* L, const char* fn)
+{
+    lua_getglobal(L, fn);
+    lua_pushinteger(L, 512);
+    lua_call(L, 1, 1);
+    bench::keep(lua_tointeger(L, -1));
+    lua_pop(L, 1);
+}
+}
+
+BENCHMARK( "default arguments" )
+{
+    const size_t iterations = 1000000;
+
+    bench::Vm lua(true);
+
+    Ltl::register_class<Conn>(lua, "Conn")
+        .add_static_function("send", &Conn::send)
+        .add_static_function("send_default", &Conn::send, Ltl::defaults(80));
+
+    luaL_dostring(lua,
+        "function shim(bytes, port) return Conn.send(bytes, port or 80) end "
+        "direct = Conn.send_default");
+
+    bench::measure("lua shim", iterations, [&]() {
+        call_global(lua, "shim");
+    });
+
+    bench::measure("Ltl::defaults", iterations, [&]() {
+        call_global(lua, "direct");
+    });
+}
@@ -0,0 +1,49 @@
+#include <cstring>
+#include <string>
+#include "bench_common.h"
+
+namespace
+{
+enum class Action { PASS, LOG, ALERT, DROP };
+
+static Action parse_action(const std::string& s)
+{
+    if ( s == "pass" )
+        return Action::PASS;
+
+    if ( s == "log" )
+        return Action::LOG;
+
+    if ( s == "alert" )
+        return Action::ALERT;
+
+    return Action::DROP;
+}
+}
+
+BENCHMARK( "enum argument" )
+{
+    const size_t iterations = 1000000;
+
+    Ltl::Enum<Action>::define({
+        { "pass", Action::PASS },
+        { "log", Action::LOG },
+        { "alert", Action::ALERT },
+        { "drop", Action::DROP }
+    });
+
+    bench::Vm lua;
+    lua_pushstring(lua, "drop");
+
+    bench::measure("check<std::string> + compare", iterations, [&]() {
+        auto a = Ltl::detail::ArgumentApplier<1, Action, std::string>::apply(
+            lua, [](std::string s) { return parse_action(s); });
+        bench::keep(a);
+    });
+
+    bench::measure("check<Action>", iterations, [&]() {
+        auto a = Ltl::detail::ArgumentApplier<1, Action, Action>::apply(
+            lua, [](Action a) { return a; });
+        bench::keep(a);
+    });
+}
@@ -0,0 +1,44 @@
+#include "bench_common.h"
+
+namespace
+{
+class Port
+{
+public:
+    int open(int number)
+    { return number; }
+};
+}
+
+BENCHMARK( "type error" )
+{
+    const size_t iterations = 200000;
+
+    bench::Vm lua;
+
+    Ltl::register_class<Port>(lua, "Port")
+        .add_ctor<>()
+        .add_function("open", &Port::open);
+
+    lua_settop(lua, 0);
+
+    lua_getglobal(lua, "Port");
+    lua_getfield(lua, 1, "new");
+    lua_call(lua, 0, 1);
+    lua_getfield(lua, 1, "open");
+
+    // stack: lib, object, method. allocs/op counts operator new only: the
+    // exception object and the lua error string are allocated elsewhere
+    bench::measure("pcall with a bad argument", iterations, [&]() {
+        lua_pushvalue(lua, 3);
+        lua_pushvalue(lua, 2);
+        lua_pushliteral(lua, "eighty");
+        bench::keep(lua_pcall(lua, 2, 1, 0));
+        lua_pop(lua, 1);
+    });
+
+    bench::measure("Ltl::name<Userdata<T>>", iterations, [&]() {
+        auto n = Ltl::name<Ltl::Userdata<Port>>(lua, 2);
+        bench::keep(n);
+    });
+}
@@ -0,0 +1,79 @@
+#include "bench_common.h"
+
+namespace
+{
+struct Point
+{
+    int x = 1;
+    int y = 2;
+
+    int sum(Point* a, Point* b, Point* c)
+    { return x + a->x + a->y + b->x + b->y + c->x + c->y; }
+};
+
+// reproduces the original handle layout and dispatch: a vptr, virtual
+// index() and valid(), and a lua_touserdata() on every dereference
+class LegacyUserdata
+{
+public:
+    LegacyUserdata(lua_State* L, int n) : L { L }, n { n } { }
+
+    virtual int index() const
+    { return n; }
+
+    virtual bool valid() const
+    { return L && n && Ltl::type<Ltl::Userdata<Point>>(L, index()); }
+
+    Point* operator->()
+    { return *static_cast<Point**>(lua_touserdata(L, index())); }
+
+private:
+    lua_State* L;
+    int n;
+};
+
+template<typename H>
+__attribute__((noinline)) static int sum_handles(H a, H b, H c)
+{ return a->x + a->y + b->x + b->y + c->x + c->y; }
+}
+
+BENCHMARK( "userdata handles" )
+{
+    const size_t iterations = 1000000;
+
+    bench::Vm lua;
+
+    Ltl::register_class<Point>(lua, "Point")
+        .add_ctor<>()
+        .add_function("sum", &Point::sum);
+
+    lua_settop(lua, 0);
+
+    lua_getglobal(lua, "Point");
+    lua_getfield(lua, 1, "new");
+    lua_call(lua, 0, 1);
+    lua_getfield(lua, 1, "sum");
+
+    // stack: lib, object, method
+    bench::measure("3 legacy handles by value", iterations, [&]() {
+        bench::keep(sum_handles(
+            LegacyUserdata(lua, 2), LegacyUserdata(lua, 2), LegacyUserdata(lua, 2)));
+    });
+
+    bench::measure("3 Userdata<T> by value", iterations, [&]() {
+        bench::keep(sum_handles(
+            Ltl::Userdata<Point>(lua, 2), Ltl::Userdata<Point>(lua, 2),
+            Ltl::Userdata<Point>(lua, 2)));
+    });
+
+    bench::measure("method with 3 userdata arguments", iterations, [&]() {
+        lua_pushvalue(lua, 3);
+        lua_pushvalue(lua, 2);
+        lua_pushvalue(lua, 2);
+        lua_pushvalue(lua, 2);
+        lua_pushvalue(lua, 2);
+        lua_call(lua, 4, 1);
+        bench::keep(lua_tointeger(lua, -1));
+        lua_pop(lua, 1);
+    });
+}
@@ -0,0 +1,24 @@
+#include <cstdint>
+#include "bench_common.h"
+
+BENCHMARK( "64-bit integers" )
+{
+    const size_t iterations = 1000000;
+
+    bench::Vm lua(true);
+    Ltl::push(lua, Ltl::UInt64(UINT64_C(0xfedcba9876543210)));
+
+    bench::measure("try_cast<UInt64> of a boxed uint64_t", iterations, [&]() {
+        auto r = Ltl::try_cast<Ltl::UInt64>(lua, 1);
+        bench::keep(r);
+    });
+
+    bench::measure("type<Int64> of a boxed uint64_t", iterations, [&]() {
+        bench::keep(Ltl::type<Ltl::Int64>(lua, 1));
+    });
+
+    bench::measure("push of a UInt64 above 2^53", iterations, [&]() {
+        Ltl::push(lua, Ltl::UInt64(UINT64_C(0xfedcba9876543210)));
+        lua_pop(lua, 1);
+    });
+}
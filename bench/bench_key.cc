@@ -0,0 +1,64 @@
+#include "bench_common.h"
+
+namespace
+{
+const char* const fields[] = {
+    "timeout", "len", "proto", "src_port", "dst_port",
+    "ttl", "flags", "window", "seq", "ack"
+};
+}
+
+BENCHMARK( "field reads" )
+{
+    const size_t iterations = 1000000;
+
+    bench::Vm lua;
+    luaL_loadstring(lua,
+        "return { timeout = 1, len = 2, proto = 3, src_port = 4, dst_port = 5, "
+        "ttl = 6, flags = 7, window = 8, seq = 9, ack = 10 }");
+    lua_call(lua, 0, 1);
+
+    bench::measure("10 x lua_getfield", iterations, [&]() {
+        int sum = 0;
+        for ( const char* f : fields )
+        {
+            lua_getfield(lua, 1, f);
+            sum += static_cast<int>(lua_tointeger(lua, -1));
+            lua_pop(lua, 1);
+        }
+
+        bench::keep(sum);
+    });
+
+    bench::measure("10 x get_field<int>(const char*)", iterations, [&]() {
+        int sum = 0;
+        for ( const char* f : fields )
+            sum += Ltl::get_field<int>(lua, 1, f);
+
+        bench::keep(sum);
+    });
+
+    std::vector<Ltl::Key> keys;
+    for ( const char* f : fields )
+        keys.emplace_back(lua, f);
+
+    // expected to match lua_getfield: the gettable dominates once the key is
+    // not hashed. the raw Table::get below is the faster path
+    bench::measure("10 x get_field<int>(Key)", iterations, [&]() {
+        int sum = 0;
+        for ( const auto& k : keys )
+            sum += Ltl::get_field<int>(lua, 1, k);
+
+        bench::keep(sum);
+    });
+
+    Ltl::Table table(lua, 1);
+
+    bench::measure("10 x Table::get<int>(Key)", iterations, [&]() {
+        int sum = 0;
+        for ( const auto& k : keys )
+            sum += table.get<int>(k);
+
+        bench::keep(sum);
+    });
+}
@@ -0,0 +1,54 @@
+#include "bench_common.h"
+
+namespace
+{
+class Meter
+{
+public:
+    double record(int bytes, int packets, double weight, bool inbound)
+    {
+        total += (bytes + packets) * weight * (inbound ? 1 : -1);
+        return total;
+    }
+
+    double total = 0;
+};
+
+template<typename Mode>
+static void run(const char* label, const char* name, size_t iterations)
+{
+    bench::Vm lua;
+
+    Ltl::register_class<Meter, Mode>(lua, name)
+        .template add_ctor<>()
+        .add_function("record", &Meter::record);
+
+    lua_settop(lua, 0);
+
+    lua_getglobal(lua, name);
+    lua_getfield(lua, 1, "new");
+    lua_call(lua, 0, 1);
+    lua_getfield(lua, 1, "record");
+
+    // stack: lib, object, method
+    bench::measure(label, iterations, [&]() {
+        lua_pushvalue(lua, 3);
+        lua_pushvalue(lua, 2);
+        lua_pushinteger(lua, 1500);
+        lua_pushinteger(lua, 1);
+        lua_pushnumber(lua, 0.5);
+        lua_pushboolean(lua, 1);
+        lua_call(lua, 5, 1);
+        bench::keep(lua_tonumber(lua, -1));
+        lua_pop(lua, 1);
+    });
+}
+}
+
+BENCHMARK( "argument checking modes" )
+{
+    const size_t iterations = 1000000;
+
+    run<Ltl::Checked>("Checked 4-argument method", "CheckedMeter", iterations);
+    run<Ltl::Trusted>("Trusted 4-argument method", "TrustedMeter", iterations);
+}
@@ -0,0 +1,58 @@
+#include <vector>
+#include "bench_common.h"
+
+BENCHMARK( "numeric array" )
+{
+    const size_t iterations = 1000;
+    const size_t count = 10000;
+
+    bench::Vm lua;
+    std::vector<double> in(count, 1.5);
+    Ltl::push_numbers(lua, in.data(), in.size());
+
+    std::vector<float> out(count);
+
+    bench::measure("cast<std::vector<float>>", iterations, [&]() {
+        auto v = Ltl::cast<std::vector<float>>(lua, -1);
+        bench::keep(v);
+    });
+
+    bench::measure("per-element cast<float>", iterations, [&]() {
+        for ( size_t i = 0; i < count; ++i )
+        {
+            lua_rawgeti(lua, -1, static_cast<int>(i + 1));
+            out[i] = Ltl::cast<float>(lua, -1);
+            lua_pop(lua, 1);
+        }
+        bench::keep(out);
+    });
+
+    bench::measure("read_numbers<float>", iterations, [&]() {
+        auto n = Ltl::read_numbers(lua, -1, out.data(), count);
+        bench::keep(n);
+    });
+
+    std::vector<int> ints(count);
+    bench::measure("read_numbers<int>", iterations, [&]() {
+        auto n = Ltl::read_numbers(lua, -1, ints.data(), count);
+        bench::keep(n);
+    });
+
+    // the conversion alone, without the lua API calls
+    bench::measure("NumberKernel<float> only", iterations, [&]() {
+        auto n = Ltl::detail::NumberKernel<float>::convert(in.data(), out.data(), count);
+        bench::keep(n);
+    });
+
+    bench::measure("per-element pushnumber + rawseti", iterations, [&]() {
+        for ( size_t i = 0; i < count; ++i )
+        {
+            lua_pushnumber(lua, out[i]);
+            lua_rawseti(lua, -2, static_cast<int>(i + 1));
+        }
+    });
+
+    bench::measure("write_numbers<float>", iterations, [&]() {
+        bench::keep(Ltl::write_numbers(lua, -1, out.data(), count));
+    });
+}
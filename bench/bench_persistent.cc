@@ -0,0 +1,53 @@
+#include "bench_common.h"
+
+BENCHMARK( "callback lookup" )
+{
+    const size_t iterations = 1000000;
+
+    bench::Vm lua;
+    luaL_dostring(lua, "function on_event(n) return n end");
+    lua_settop(lua, 0);
+
+    bench::measure("getglobal + call", iterations, [&]() {
+        lua_getglobal(lua, "on_event");
+        lua_pushinteger(lua, 1);
+        lua_call(lua, 1, 1);
+        bench::keep(lua_tointeger(lua, -1));
+        lua_pop(lua, 1);
+    });
+
+    lua_getglobal(lua, "on_event");
+    Ltl::PersistentFunc on_event(Ltl::Func(lua, -1));
+    lua_pop(lua, 1);
+
+    bench::measure("PersistentFunc::push + call", iterations, [&]() {
+        on_event.push();
+        lua_pushinteger(lua, 1);
+        lua_call(lua, 1, 1);
+        bench::keep(lua_tointeger(lua, -1));
+        lua_pop(lua, 1);
+    });
+
+    lua_getglobal(lua, "on_event");
+    Ltl::WeakFunc weak_on_event(Ltl::Func(lua, -1));
+    lua_pop(lua, 1);
+
+    bench::measure("WeakFunc::lock + call", iterations, [&]() {
+        weak_on_event.lock();
+        lua_pushinteger(lua, 1);
+        lua_call(lua, 1, 1);
+        bench::keep(lua_tointeger(lua, -1));
+        lua_pop(lua, 1);
+    });
+
+    lua_newtable(lua);
+    bench::measure("PersistentRef create + release", iterations, [&]() {
+        Ltl::PersistentRef ref(lua, -1);
+        bench::keep(ref);
+    });
+
+    bench::measure("WeakRef create + release", iterations, [&]() {
+        Ltl::WeakRef ref(lua, -1);
+        bench::keep(ref);
+    });
+}
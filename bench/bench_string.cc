@@ -0,0 +1,23 @@
+#include <string>
+#include "bench_common.h"
+
+BENCHMARK( "string argument" )
+{
+    const size_t iterations = 1000000;
+
+    bench::Vm lua;
+    std::string body(4096, 'x');
+    lua_pushlstring(lua, body.data(), body.size());
+
+    bench::measure("check<std::string>", iterations, [&]() {
+        auto s = Ltl::detail::ArgumentApplier<1, size_t, std::string>::apply(
+            lua, [](std::string s) { return s.size(); });
+        bench::keep(s);
+    });
+
+    bench::measure("check<StringView>", iterations, [&]() {
+        auto s = Ltl::detail::ArgumentApplier<1, size_t, Ltl::StringView>::apply(
+            lua, [](Ltl::StringView s) { return s.size(); });
+        bench::keep(s);
+    });
+}
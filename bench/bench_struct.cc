@@ -0,0 +1,66 @@
+#include <cstdint>
+#include "bench_common.h"
+
+namespace
+{
+struct Packet
+{
+    uint32_t src;
+    uint32_t dst;
+    uint16_t sport;
+    uint16_t dport;
+    uint8_t proto;
+};
+
+static void push_by_name(lua_State* L, const Packet& p)
+{
+    lua_createtable(L, 0, 5);
+    lua_pushinteger(L, p.src);
+    lua_setfield(L, -2, "src");
+    lua_pushinteger(L, p.dst);
+    lua_setfield(L, -2, "dst");
+    lua_pushinteger(L, p.sport);
+    lua_setfield(L, -2, "sport");
+    lua_pushinteger(L, p.dport);
+    lua_setfield(L, -2, "dport");
+    lua_pushinteger(L, p.proto);
+    lua_setfield(L, -2, "proto");
+}
+}
+
+template<>
+struct Ltl::StructDef<Packet> :
+    Ltl::Fields<Packet, uint32_t, uint32_t, uint16_t, uint16_t, uint8_t>
+{
+    StructDef() : Fields(
+        { "src", &Packet::src },
+        { "dst", &Packet::dst },
+        { "sport", &Packet::sport },
+        { "dport", &Packet::dport },
+        { "proto", &Packet::proto }) { }
+};
+
+BENCHMARK( "struct conversion" )
+{
+    const size_t iterations = 1000000;
+
+    bench::Vm lua;
+    Packet p { 1, 2, 1024, 80, 6 };
+
+    bench::measure("push by lua_setfield", iterations, [&]() {
+        push_by_name(lua, p);
+        lua_pop(lua, 1);
+    });
+
+    bench::measure("push<Packet>", iterations, [&]() {
+        Ltl::push(lua, p);
+        lua_pop(lua, 1);
+    });
+
+    Ltl::push(lua, p);
+
+    bench::measure("cast<Packet>", iterations, [&]() {
+        auto v = Ltl::cast<Packet>(lua, -1);
+        bench::keep(v);
+    });
+}
@@ -0,0 +1,49 @@
+#include "bench_common.h"
+
+BENCHMARK( "table read" )
+{
+    const size_t iterations = 100;
+    const int entries = 100000;
+
+    bench::Vm lua;
+    lua_createtable(lua, entries, 0);
+
+    for ( int i = 1; i <= entries; ++i )
+    {
+        lua_pushinteger(lua, i);
+        lua_rawseti(lua, 1, i);
+    }
+
+    bench::measure("lua_pushinteger + lua_gettable (100k)", iterations, [&]() {
+        long sum = 0;
+        for ( int i = 1; i <= entries; ++i )
+        {
+            lua_pushinteger(lua, i);
+            lua_gettable(lua, 1);
+            sum += lua_tointeger(lua, -1);
+            lua_pop(lua, 1);
+        }
+
+        bench::keep(sum);
+    });
+
+    Ltl::Table table(lua, 1);
+
+    bench::measure("Table::get<int> (100k)", iterations, [&]() {
+        long sum = 0;
+        int size = static_cast<int>(table.size());
+
+        for ( int i = 1; i <= size; ++i )
+            sum += table.get<int>(i);
+
+        bench::keep(sum);
+    });
+
+    bench::measure("Table iteration (100k)", iterations, [&]() {
+        long sum = 0;
+        for ( const auto& e : table )
+            sum += e.value.to<int>();
+
+        bench::keep(sum);
+    });
+}
@@ -0,0 +1,67 @@
+#include "bench_common.h"
+
+namespace
+{
+class Widget
+{
+public:
+    int value = 0;
+};
+
+// reproduces the original TypePolicy<userdata_tag> check: copy the type name,
+// look the metatable up by name and compare with lua_equal
+template<typename T>
+static bool named_type_check(lua_State* L, int n)
+{
+    if ( lua_type(L, n) != LUA_TUSERDATA )
+        return false;
+
+    std::string name = T::userdata_type_name;
+    if ( name.empty() )
+        return false;
+
+    luaL_getmetatable(L, name.c_str());
+    if ( lua_isnil(L, -1) )
+    {
+        lua_pop(L, 1);
+        return false;
+    }
+
+    lua_getmetatable(L, n);
+    bool match = lua_equal(L, -1, -2);
+    lua_pop(L, 2);
+
+    return match;
+}
+}
+
+BENCHMARK( "userdata type check" )
+{
+    const size_t iterations = 1000000;
+
+    bench::Vm lua;
+
+    // long enough to defeat the small string optimization, like most
+    // qualified class names
+    Ltl::register_class<Widget>(lua, "bench.userdata.RegisteredWidget");
+
+    auto h = static_cast<Widget**>(lua_newuserdata(lua, sizeof(Widget*)));
+    *h = new Widget; // owned by the registered __gc
+    luaL_getmetatable(lua, "bench.userdata.RegisteredWidget");
+    lua_setmetatable(lua, -2);
+
+    int ud = lua_gettop(lua);
+
+    bench::measure("by name (original)", iterations, [&]() {
+        bench::keep(named_type_check<Ltl::Userdata<Widget>>(lua, ud));
+    });
+
+    bench::measure("Ltl::type<Userdata<T>> (cached metatable)", iterations, [&]() {
+        bench::keep(Ltl::type<Ltl::Userdata<Widget>>(lua, ud));
+    });
+
+    bench::measure("Ltl::check<T>", iterations, [&]() {
+        Widget* p = Ltl::check<Widget>(lua, ud);
+        bench::keep(p);
+    });
+}
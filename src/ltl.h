@@ -2,10 +2,22 @@
 #define LTL_H
 
 #include "lua_stack_api.h"
+#include "lua_stack_guard.h"
 #include "lua_ref.h"
+#include "lua_stack_view.h"
+#include "lua_arg.h"
 #include "lua_function.h"
+#include "lua_table.h"
+#include "lua_persistent.h"
+#include "lua_weak_ref.h"
+#include "lua_key.h"
+#include "lua_callsite.h"
 #include "lua_userdata.h"
 #include "lua_registration.h"
 #include "lua_sandbox.h"
+#include "lua_container.h"
+#include "lua_tuple.h"
+#include "lua_numbers.h"
+#include "lua_struct.h"
 
 #endif
@@ -0,0 +1,342 @@
+#ifndef LUA_ARG_H
+#define LUA_ARG_H
+
+#include <cstddef>
+#include <type_traits>
+#include <luajit-2.0/lua.hpp>
+
+#include "lua_exception.h"
+#include "lua_stack_api.h"
+#include "lua_sandbox.h"
+
+namespace Ltl
+{
+
+namespace detail
+{
+
+// a cached argument: its lua type and, for the basic types, its value
+struct ArgSlot
+{
+    // the slot has not been read yet
+    static constexpr int unloaded = LUA_TNONE - 1;
+
+    struct String
+    {
+        const char* data;
+        size_t len;
+    };
+
+    int type;
+
+    union
+    {
+        lua_Number number;
+        bool boolean;
+        const void* pointer;
+        String string;
+    };
+
+    void load(lua_State* L, int n)
+    {
+        type = lua_type(L, n);
+
+        switch ( type )
+        {
+            case LUA_TNUMBER:
+                number = lua_tonumber(L, n);
+                break;
+
+            case LUA_TBOOLEAN:
+                boolean = lua_toboolean(L, n);
+                break;
+
+            case LUA_TLIGHTUSERDATA:
+                pointer = lua_topointer(L, n);
+                break;
+
+            case LUA_TSTRING:
+                string.data = lua_tolstring(L, n, &string.len);
+                break;
+
+            default:
+                break;
+        }
+    }
+};
+
+// converts a cached slot. the conversions match the try_cast policies of
+// lua_stack_core.h. types without a specialization (userdata, int64, enums,
+// containers...) are read from the stack each time
+template<typename Tag>
+struct ArgCachePolicy
+{ static constexpr bool cached = false; };
+
+template<>
+struct ArgCachePolicy<floating_point_tag>
+{
+    static constexpr bool cached = true;
+
+    template<typename T>
+    static CastResult<T> try_cast(const ArgSlot& s)
+    {
+        if ( s.type != LUA_TNUMBER )
+            return { 0, false };
+
+        return { static_cast<T>(s.number), true };
+    }
+};
+
+template<>
+struct ArgCachePolicy<integral_tag>
+{
+    static constexpr bool cached = true;
+
+    template<typename T>
+    static CastResult<T> try_cast(const ArgSlot& s)
+    {
+        if ( s.type != LUA_TNUMBER )
+            return { 0, false };
+
+        return { static_cast<T>(static_cast<lua_Integer>(s.number)), true };
+    }
+};
+
+template<>
+struct ArgCachePolicy<unsigned_tag>
+{
+    static constexpr bool cached = true;
+
+    template<typename T>
+    static CastResult<T> try_cast(const ArgSlot& s)
+    {
+        if ( s.type != LUA_TNUMBER )
+            return { 0, false };
+
+        auto v = static_cast<lua_Integer>(s.number);
+        if ( v < 0 )
+            return { 0, false };
+
+        return { static_cast<T>(v), true };
+    }
+};
+
+template<>
+struct ArgCachePolicy<boolean_tag>
+{
+    static constexpr bool cached = true;
+
+    template<typename T>
+    static CastResult<T> try_cast(const ArgSlot& s)
+    {
+        if ( s.type != LUA_TBOOLEAN )
+            return { false, false };
+
+        return { static_cast<T>(s.boolean), true };
+    }
+};
+
+template<>
+struct ArgCachePolicy<pointer_tag>
+{
+    static constexpr bool cached = true;
+
+    template<typename T>
+    static CastResult<T> try_cast(const ArgSlot& s)
+    {
+        if ( s.type != LUA_TLIGHTUSERDATA )
+            return { nullptr, false };
+
+        return { static_cast<T>(const_cast<void*>(s.pointer)), true };
+    }
+};
+
+template<>
+struct ArgCachePolicy<string_tag>
+{
+    static constexpr bool cached = true;
+
+    template<typename T>
+    static CastResult<T> try_cast(const ArgSlot& s)
+    {
+        if ( s.type != LUA_TSTRING )
+            return { T(), false };
+
+        return { T(s.string.data, s.string.len), true };
+    }
+};
+
+template<>
+struct ArgCachePolicy<cstring_tag>
+{
+    static constexpr bool cached = true;
+
+    template<typename T>
+    static CastResult<T> try_cast(const ArgSlot& s)
+    {
+        if ( s.type != LUA_TSTRING )
+            return { nullptr, false };
+
+        return { s.string.data, true };
+    }
+};
+
+// only basic types are cached. pointers to classes are checked as userdata
+template<typename T>
+using arg_cache_policy_t = ArgCachePolicy<typename std::conditional<
+    std::is_same<typename CheckTrait<T>::tag, default_tag>::value,
+    typename TryCastTrait<T>::tag, userdata_tag>::type>;
+
+} // namespace detail
+
+// the arguments of a C function, addressed from 1 relative to bottom. a bound
+// functor taking (Ltl::Arg&, Class*) receives the arguments after self:
+//
+//     .add_function("scaled", [](Ltl::Arg& arg, Foo* self)
+//     { return self->scale(arg[1], arg[2].as<int>() + 1); })
+//
+// the first inline_slots arguments are read from the stack (lua_type and the
+// value) at most once, on first access, and kept in an inline buffer. later
+// reads of the same slot convert the cached value without touching the stack.
+// string data is owned by lua and stays valid while the argument is on the
+// stack. other arguments are read from the stack on every access. an Arg
+// never allocates
+class Arg
+{
+public:
+    static constexpr int inline_slots = 8;
+
+    // an argument converted on use, as in f(arg[1]) or int n = arg[1].
+    // conversions are checked and throw a TypeError on mismatch
+    class Value
+    {
+    public:
+        Value(Arg& a, int i) : a(a), i { i } { }
+
+        template<typename T>
+        operator T() const
+        { return a.check<T>(i); }
+
+        template<typename T>
+        detail::userdata_wrapped_t<T> as() const
+        { return a.check<T>(i); }
+
+        int type() const
+        { return a.type(i); }
+
+    private:
+        Arg& a;
+        int i;
+    };
+
+    Arg(lua_State* L, int bottom = 1) :
+        L { L }, bottom { bottom }, count { lua_gettop(L) - bottom + 1 }
+    {
+        if ( count < 0 )
+            count = 0;
+
+        for ( auto& s : slots )
+            s.type = detail::ArgSlot::unloaded;
+    }
+
+    Arg(const Arg&) = delete;
+    Arg& operator=(const Arg&) = delete;
+
+    int size() const
+    { return count; }
+
+    lua_State* state() const
+    { return L; }
+
+    // the absolute stack index of argument i. any slot beyond the arguments
+    // reads as none
+    int index(int i) const
+    {
+        if ( i >= 1 && i <= count )
+            return bottom + i - 1;
+
+        return lua_gettop(L) + 1;
+    }
+
+    // the lua type of argument i (LUA_TNONE beyond the arguments)
+    int type(int i)
+    {
+        if ( i >= 1 && i <= inline_slots )
+            return slot(i).type;
+
+        return lua_type(L, index(i));
+    }
+
+    Value operator[](int i)
+    { return Value(*this, i); }
+
+    // argument i, or zero<T>() if it cannot be converted
+    template<typename T>
+    T get(int i)
+    { return get<T>(i, cached<T>()); }
+
+    // argument i. throws a TypeError if it cannot be converted
+    template<typename T>
+    detail::userdata_wrapped_t<T> check(int i)
+    { return check<T>(i, cached<T>()); }
+
+private:
+    template<typename T>
+    using cached = std::integral_constant<bool,
+        detail::arg_cache_policy_t<T>::cached>;
+
+    const detail::ArgSlot& slot(int i)
+    {
+        auto& s = slots[i - 1];
+        if ( s.type == detail::ArgSlot::unloaded )
+        {
+            if ( i <= count )
+                s.load(L, bottom + i - 1);
+            else
+                s.type = LUA_TNONE;
+        }
+
+        return s;
+    }
+
+    template<typename T>
+    T get(int i, std::true_type)
+    {
+        if ( i < 1 || i > inline_slots )
+            return Ltl::get<T>(L, index(i));
+
+        auto r = detail::arg_cache_policy_t<T>::template try_cast<T>(slot(i));
+        return r.ok ? r.value : zero<T>(L, index(i));
+    }
+
+    template<typename T>
+    T get(int i, std::false_type)
+    { return Ltl::get<T>(L, index(i)); }
+
+    template<typename T>
+    detail::userdata_wrapped_t<T> check(int i, std::true_type)
+    {
+        if ( i < 1 || i > inline_slots )
+            return Ltl::check<T>(L, index(i));
+
+        const auto& s = slot(i);
+        auto r = detail::arg_cache_policy_t<T>::template try_cast<T>(s);
+        if ( !r.ok )
+            throw TypeError(index(i), name<T>(L, index(i)), s.type);
+
+        return r.value;
+    }
+
+    template<typename T>
+    detail::userdata_wrapped_t<T> check(int i, std::false_type)
+    { return Ltl::check<T>(L, index(i)); }
+
+    lua_State* L;
+    int bottom;
+    int count;
+    detail::ArgSlot slots[inline_slots];
+};
+
+}
+
+#endif
@@ -0,0 +1,227 @@
+#ifndef LUA_CALLSITE_H
+#define LUA_CALLSITE_H
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <luajit-2.0/lua.hpp>
+
+#include "lua_stack_api.h"
+#include "lua_function.h"
+#include "lua_persistent.h"
+#include "lua_sandbox.h"
+
+namespace Ltl
+{
+
+namespace detail
+{
+
+// how a call site converts its results. Checked validates them and reports
+// lua_errresult on mismatch. Trusted casts them (builds without NDEBUG still
+// check)
+template<typename Mode>
+struct ResultPolicy
+{
+    template<typename T>
+    static CallResult<T> read(lua_State* L, int n, int base)
+    { return ResultReader<T>::try_cast(L, n, base); }
+};
+
+#ifdef NDEBUG
+template<>
+struct ResultPolicy<Trusted>
+{
+    template<typename T>
+    static CallResult<T> read(lua_State* L, int n, int base)
+    { return ResultReader<T>::unchecked(L, n, base); }
+};
+#endif
+
+} // namespace detail
+
+template<typename Signature, typename Mode = DefaultMode>
+class CallSite;
+
+// a prepared protected call of a lua function. the function, the message
+// handler and any bound leading arguments are anchored in the registry when
+// the call site is created, so a call is a few raw gets, the argument pushes,
+// one lua_pcall and the result conversion:
+//
+//     Ltl::CallSite<bool(int)> classify(func, "tcp");
+//     auto r = classify(port);   // classify("tcp", port)
+//
+// R may be void, a single value, a std::tuple of values or a StackView (which
+// leaves the results on the stack). strings are returned as std::string, as
+// the other results are popped
+template<typename R, typename... Args, typename Mode>
+class CallSite<R(Args...), Mode>
+{
+    static_assert(!detail::NonOwning<R>::value,
+        "call site results are popped after the call: use std::string, or "
+        "StackView to keep them on the stack");
+
+public:
+    using result_type = CallResult<R>;
+
+    CallSite() : slots { 0 } { }
+
+    // the bound values are converted once, here
+    template<typename... Bound>
+    explicit CallSite(const Func& f, Bound&&... bound) : slots { 0 }
+    {
+        if ( !f.valid() )
+            return;
+
+        lua_State* L = f.state();
+
+        detail::ErrorHandler::push(L);
+        handler = PersistentRef(L, -1);
+        lua_pop(L, 1);
+
+        func = PersistentFunc(f);
+
+        int top = lua_gettop(L);
+        push_all(L, std::forward<Bound>(bound)...);
+
+        for ( int i = top + 1; i <= lua_gettop(L); ++i )
+            args.emplace_back(L, i);
+
+        lua_settop(L, top);
+
+        // handler, function and arguments. the results replace the function
+        // and arguments
+        int call_slots = static_cast<int>(args.size()) + arg_count + 1;
+        if ( call_slots < result_count )
+            call_slots = result_count;
+
+        // the stack is checked by each call. space reserved here could be
+        // used up by the time a call is made
+        slots = 1 + call_slots + detail::push_scratch;
+    }
+
+    CallSite(const CallSite&) = delete;
+    CallSite& operator=(const CallSite&) = delete;
+
+    CallSite(CallSite&&) = default;
+    CallSite& operator=(CallSite&&) = default;
+
+    bool valid() const
+    { return func.valid(); }
+
+    // the call site must be valid
+    result_type operator()(Args... call_args) const
+    {
+        lua_State* L = func.state();
+        int base = lua_gettop(L);
+
+        // lua_State guarantees LUA_MINSTACK free slots to the running C
+        // function, which covers most call sites
+        if ( slots > LUA_MINSTACK )
+            luaL_checkstack(L, slots, "cannot call function");
+
+        handler.push(L);
+        func.push(L);
+
+        for ( const auto& a : args )
+            a.push(L);
+
+        push_all(L, std::forward<Args>(call_args)...);
+
+        int nargs = static_cast<int>(args.size()) + arg_count;
+        int status = lua_pcall(L, nargs, result_count, base + 1);
+
+        if ( status )
+        {
+            const char* message = lua_tostring(L, -1);
+            auto r = detail::ResultReader<R>::error(
+                status, message ? message : "(error object is not a string)");
+
+            lua_settop(L, base);
+            return r;
+        }
+
+        return detail::ResultPolicy<Mode>::template read<R>(L, base + 2, base);
+    }
+
+private:
+    static constexpr int arg_count =
+        detail::TotalPushCount<typename std::decay<Args>::type...>::value;
+
+    static constexpr int result_count = detail::Results<R>::count;
+
+    PersistentRef handler;
+    PersistentFunc func;
+    std::vector<PersistentRef> args;
+    int slots;
+};
+
+// call f once per element of [begin, end), writing a CallResult<R> per element
+// to out. elements are pushed through the push policies (a std::tuple element
+// is passed as several arguments). a failed call is reported in its result
+// and does not stop the batch. the message handler and the function are
+// pushed once, and the stack is restored when the batch is done. returns the
+// number of calls that succeeded
+template<typename R, typename Mode = DefaultMode, typename It, typename Out>
+static inline size_t call_batch(const Func& f, It begin, It end, Out out)
+{
+    using value_type = typename std::decay<decltype(*begin)>::type;
+
+    static_assert(!std::is_same<R, StackView>::value,
+        "call_batch results are converted, not left on the stack");
+
+    static_assert(!detail::NonOwning<R>::value,
+        "call_batch results are popped after each call: use std::string");
+
+    constexpr int arg_count = detail::PushCount<value_type>::value;
+    constexpr int result_count = detail::PushCount<R>::value;
+    constexpr int call_slots = 1 + (arg_count > result_count ? arg_count : result_count);
+
+    lua_State* L = f.state();
+    int base = lua_gettop(L);
+
+    luaL_checkstack(L, 2 + call_slots + detail::push_scratch, "cannot call function");
+
+    // f may be at a relative or pseudo-index, so it is pushed before the
+    // handler is
+    push(L, f);
+    detail::ErrorHandler::push(L);
+    lua_insert(L, base + 1);
+
+    int handler = base + 1;
+    int fn = base + 2;
+
+    size_t succeeded = 0;
+
+    for ( ; begin != end; ++begin )
+    {
+        // the stack was reserved for a single call before the loop
+        lua_pushvalue(L, fn);
+        push(L, *begin);
+
+        int status = lua_pcall(L, arg_count, result_count, handler);
+        if ( status )
+        {
+            const char* message = lua_tostring(L, -1);
+            *out++ = detail::ResultReader<R>::error(
+                status, message ? message : "(error object is not a string)");
+
+            lua_settop(L, fn);
+            continue;
+        }
+
+        auto r = detail::ResultPolicy<Mode>::template read<R>(L, fn + 1, fn);
+        if ( r.ok() )
+            ++succeeded;
+
+        *out++ = std::move(r);
+    }
+
+    lua_settop(L, base);
+    return succeeded;
+}
+
+}
+
+#endif
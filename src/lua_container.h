@@ -0,0 +1,379 @@
+#ifndef LUA_CONTAINER_H
+#define LUA_CONTAINER_H
+
+#include <array>
+#include <map>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <luajit-2.0/lua.hpp>
+
+#include "lua_stack_api.h"
+#include "lua_userdata.h"
+#include "lua_sandbox.h"
+#include "lua_util.h"
+
+namespace Ltl
+{
+
+namespace detail
+{
+
+struct sequence_tag {};
+struct map_tag {};
+
+// -----------------------------------------------------------------------------
+// container type traits
+// -----------------------------------------------------------------------------
+template<typename T>
+struct ContainerTraits
+{
+    static constexpr bool is_sequence = false;
+    static constexpr bool is_map = false;
+};
+
+template<typename E, typename A>
+struct ContainerTraits<std::vector<E, A>>
+{
+    static constexpr bool is_sequence = true;
+    static constexpr bool is_map = false;
+
+    using element_type = E;
+
+    static bool prepare(std::vector<E, A>& out, size_t& len)
+    {
+        out.reserve(len);
+        return true;
+    }
+
+    static void insert(std::vector<E, A>& out, size_t, E&& v)
+    { out.push_back(std::move(v)); }
+};
+
+template<typename E, size_t N>
+struct ContainerTraits<std::array<E, N>>
+{
+    static constexpr bool is_sequence = true;
+    static constexpr bool is_map = false;
+
+    using element_type = E;
+
+    // fixed size arrays only accept tables of the same length. longer
+    // tables are truncated
+    static bool prepare(std::array<E, N>&, size_t& len)
+    {
+        bool exact = len == N;
+        if ( len > N )
+            len = N;
+
+        return exact;
+    }
+
+    static void insert(std::array<E, N>& out, size_t i, E&& v)
+    { out[i] = std::move(v); }
+};
+
+template<typename K, typename V, typename C, typename A>
+struct ContainerTraits<std::map<K, V, C, A>>
+{
+    static constexpr bool is_sequence = false;
+    static constexpr bool is_map = true;
+
+    using key_type = K;
+    using element_type = V;
+};
+
+template<typename K, typename V, typename H, typename E, typename A>
+struct ContainerTraits<std::unordered_map<K, V, H, E, A>>
+{
+    static constexpr bool is_sequence = false;
+    static constexpr bool is_map = true;
+
+    using key_type = K;
+    using element_type = V;
+};
+
+template<typename T>
+struct is_container
+{
+    static constexpr bool value =
+        ContainerTraits<T>::is_sequence || ContainerTraits<T>::is_map;
+};
+
+// -----------------------------------------------------------------------------
+// element conversion
+// -----------------------------------------------------------------------------
+template<typename E, typename Enable = void>
+struct Element
+{
+    static CastResult<E> try_cast(lua_State* L, int n)
+    { return Ltl::try_cast<E>(L, n); }
+};
+
+// pointers to class types are read from registered userdata as well as
+// light userdata
+template<typename E>
+struct Element<E*, typename std::enable_if<std::is_class<E>::value>::type>
+{
+    static CastResult<E*> try_cast(lua_State* L, int n)
+    {
+        if ( lua_type(L, n) != LUA_TUSERDATA )
+            return Ltl::try_cast<E*>(L, n);
+
+        auto r = Ltl::try_cast<Userdata<typename std::remove_cv<E>::type>>(L, n);
+        if ( !r.ok )
+            return { nullptr, false };
+
+        return { r.value, true };
+    }
+};
+
+// read the table at index n into out. if strict is set, stop at the first
+// element that cannot be converted and return false. otherwise, such elements
+// are value-initialized
+template<typename T>
+static inline bool read_sequence(lua_State* L, int n, T& out, bool strict)
+{
+    using traits = ContainerTraits<T>;
+    using element_type = typename traits::element_type;
+
+    n = util::abs_index(L, n);
+    size_t len = lua_objlen(L, n);
+
+    if ( !traits::prepare(out, len) && strict )
+        return false;
+
+    for ( size_t i = 0; i < len; ++i )
+    {
+        lua_rawgeti(L, n, static_cast<int>(i + 1));
+        auto r = Element<element_type>::try_cast(L, -1);
+        lua_pop(L, 1);
+
+        if ( !r.ok )
+        {
+            if ( strict )
+                return false;
+
+            r.value = element_type();
+        }
+
+        traits::insert(out, i, std::move(r.value));
+    }
+
+    return true;
+}
+
+template<typename T>
+static inline bool read_map(lua_State* L, int n, T& out, bool strict)
+{
+    using traits = ContainerTraits<T>;
+    using key_type = typename traits::key_type;
+    using element_type = typename traits::element_type;
+
+    n = util::abs_index(L, n);
+    lua_pushnil(L);
+
+    while ( lua_next(L, n) )
+    {
+        auto k = Element<key_type>::try_cast(L, -2);
+        auto v = Element<element_type>::try_cast(L, -1);
+        lua_pop(L, 1);
+
+        if ( !k.ok || !v.ok )
+        {
+            if ( strict )
+            {
+                lua_pop(L, 1);
+                return false;
+            }
+
+            // a key that cannot be converted has nowhere to go
+            if ( !k.ok )
+                continue;
+
+            v.value = element_type();
+        }
+
+        out.emplace(std::move(k.value), std::move(v.value));
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// policies
+// -----------------------------------------------------------------------------
+template<>
+struct PushPolicy<sequence_tag>
+{
+    template<typename T>
+    static void push(lua_State* L, const T& v)
+    {
+        lua_createtable(L, static_cast<int>(v.size()), 0);
+        luaL_checkstack(L, 1 + push_scratch, "cannot push container");
+
+        int i = 0;
+        for ( const auto& e : v )
+        {
+            Ltl::push(L, e);
+            lua_rawseti(L, -2, ++i);
+        }
+    }
+};
+
+template<>
+struct PushPolicy<map_tag>
+{
+    template<typename T>
+    static void push(lua_State* L, const T& v)
+    {
+        lua_createtable(L, 0, static_cast<int>(v.size()));
+        luaL_checkstack(L, 2 + push_scratch, "cannot push container");
+
+        for ( const auto& e : v )
+        {
+            Ltl::push(L, e.first);
+            Ltl::push(L, e.second);
+            lua_rawset(L, -3);
+        }
+    }
+};
+
+// cast does no type checking. elements which cannot be converted are
+// value-initialized
+template<>
+struct CastPolicy<sequence_tag>
+{
+    template<typename T>
+    static T cast(lua_State* L, int n)
+    {
+        T out {};
+        if ( lua_istable(L, n) )
+            read_sequence(L, n, out, false);
+
+        return out;
+    }
+};
+
+template<>
+struct CastPolicy<map_tag>
+{
+    template<typename T>
+    static T cast(lua_State* L, int n)
+    {
+        T out;
+        if ( lua_istable(L, n) )
+            read_map(L, n, out, false);
+
+        return out;
+    }
+};
+
+// try_cast fails if any element cannot be converted
+template<>
+struct TryCastPolicy<sequence_tag>
+{
+    template<typename T>
+    static CastResult<T> try_cast(lua_State* L, int n)
+    {
+        T out {};
+        if ( !lua_istable(L, n) || !read_sequence(L, n, out, true) )
+            return { T {}, false };
+
+        return { std::move(out), true };
+    }
+};
+
+template<>
+struct TryCastPolicy<map_tag>
+{
+    template<typename T>
+    static CastResult<T> try_cast(lua_State* L, int n)
+    {
+        T out;
+        if ( !lua_istable(L, n) || !read_map(L, n, out, true) )
+            return { T(), false };
+
+        return { std::move(out), true };
+    }
+};
+
+template<>
+struct ZeroPolicy<sequence_tag>
+{
+    template<typename T>
+    static T zero(lua_State*, int)
+    { return T {}; }
+};
+
+template<>
+struct ZeroPolicy<map_tag>
+{
+    template<typename T>
+    static T zero(lua_State*, int)
+    { return T(); }
+};
+
+// -----------------------------------------------------------------------------
+// trait specializations
+// -----------------------------------------------------------------------------
+template<typename T>
+struct PushTrait<T, typename std::enable_if<ContainerTraits<T>::is_sequence>::type>
+{ using tag = sequence_tag; };
+
+template<typename T>
+struct PushTrait<T, typename std::enable_if<ContainerTraits<T>::is_map>::type>
+{ using tag = map_tag; };
+
+template<typename T>
+struct CastTrait<T, typename std::enable_if<ContainerTraits<T>::is_sequence>::type>
+{ using tag = sequence_tag; };
+
+template<typename T>
+struct CastTrait<T, typename std::enable_if<ContainerTraits<T>::is_map>::type>
+{ using tag = map_tag; };
+
+template<typename T>
+struct TryCastTrait<T, typename std::enable_if<ContainerTraits<T>::is_sequence>::type>
+{ using tag = sequence_tag; };
+
+template<typename T>
+struct TryCastTrait<T, typename std::enable_if<ContainerTraits<T>::is_map>::type>
+{ using tag = map_tag; };
+
+// type() only checks for a table. use try_cast() to validate the elements
+template<typename T>
+struct TypeTrait<T, typename std::enable_if<is_container<T>::value>::type>
+{ using tag = default_tag; };
+
+template<typename T>
+struct ZeroTrait<T, typename std::enable_if<ContainerTraits<T>::is_sequence>::type>
+{ using tag = sequence_tag; };
+
+template<typename T>
+struct ZeroTrait<T, typename std::enable_if<ContainerTraits<T>::is_map>::type>
+{ using tag = map_tag; };
+
+template<typename T>
+struct NameTrait<T, typename std::enable_if<is_container<T>::value>::type>
+{ using tag = default_tag; };
+
+template<typename T>
+struct LuaType<T, typename std::enable_if<is_container<T>::value>::type>
+{ static constexpr int code = LUA_TTABLE; };
+
+// containers are checked by value rather than as userdata
+template<typename T>
+struct CheckTrait<T, typename std::enable_if<is_container<T>::value>::type>
+{ using tag = default_tag; };
+
+template<typename T>
+struct add_userdata_wrapper<T, typename std::enable_if<is_container<T>::value>::type>
+{ using type = T; };
+
+} // namespace detail
+
+}
+
+#endif
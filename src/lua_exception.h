@@ -1,8 +1,7 @@
 #ifndef LUA_EXCEPTION_H
 #define LUA_EXCEPTION_H
 
-#include <string>
-#include <sstream>
+#include <cstdio>
 
 namespace Ltl
 {
@@ -10,24 +9,56 @@ namespace Ltl
 class Exception
 {
 public:
-    virtual std::string what() = 0;
+    virtual ~Exception() { }
+    virtual const char* what() const = 0;
 };
 
+// the message is only formatted when what() is called, so raising (and
+// catching) a TypeError makes no operator new allocation. the C++ runtime
+// still allocates the exception object, and a binding that turns it into a
+// lua error copies the message into a lua string.
+//
+// what() formats into the object on its first call, so it must not be called
+// concurrently on the same TypeError
 class TypeError : public Exception
 {
 public:
-    TypeError(std::string expected, std::string actual = "") :
-        expected { expected }, actual { actual } { }
+    // expected must be a statically allocated type name (see Ltl::name())
+    TypeError(int index, const char* expected, int actual) :
+        index { index }, expected { expected }, actual { actual } { }
 
-    virtual std::string what() override
+    virtual const char* what() const override
     {
-        std::ostringstream oss;
-        oss << "TypeError: expected " << expected << ", got " << expected;
-        return oss.str();
+        if ( !*message )
+        {
+            std::snprintf(message, sizeof(message),
+                "TypeError: expected %s, got %s (index %d)",
+                expected, type_name(actual), index);
+        }
+
+        return message;
+    }
+
+    int index;
+    const char* expected;
+    int actual;
+
+private:
+    // lua_typename() without a lua_State
+    static const char* type_name(int t)
+    {
+        static const char* const names[] = {
+            "nil", "boolean", "userdata", "number", "string",
+            "table", "function", "userdata", "thread", "proto", "cdata"
+        };
+
+        if ( t < 0 || t >= int(sizeof(names) / sizeof(names[0])) )
+            return "no value";
+
+        return names[t];
     }
 
-    std::string expected;
-    std::string actual;
+    mutable char message[128] = { };
 };
 
 }
@@ -1,12 +1,221 @@
 #ifndef LUA_FUNC_H
 #define LUA_FUNC_H
 
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <luajit-2.0/lua.hpp>
+
 #include "lua_ref.h"
+#include "lua_stack_view.h"
+#include "lua_tuple.h"
+#include "lua_util.h"
 
 namespace Ltl
 {
 
+// status of a protected call whose results could not be converted. this is
+// not a lua status code
+static constexpr int lua_errresult = LUA_ERRERR + 1;
+
+// result of a protected call. value is only meaningful if ok()
+template<typename T>
+struct CallResult
+{
+    T value;
+    int status;
+
+    // the error message and traceback, set if status is not 0
+    std::string error;
+
+    bool ok() const
+    { return status == 0; }
+
+    explicit operator bool() const
+    { return ok(); }
+};
+
+template<>
+struct CallResult<void>
+{
+    int status;
+    std::string error;
+
+    bool ok() const
+    { return status == 0; }
+
+    explicit operator bool() const
+    { return ok(); }
+};
+
+namespace detail
+{
+
+// message handler for protected calls. it is created once per state and kept
+// in the registry, so a call only pays for a raw get. the traceback is only
+// built if the call fails
+struct ErrorHandler
+{
+    static void* key()
+    {
+        static char k;
+        return &k;
+    }
+
+    static void push(lua_State* L)
+    {
+        lua_pushlightuserdata(L, key());
+        lua_rawget(L, LUA_REGISTRYINDEX);
+
+        if ( !lua_isnil(L, -1) )
+            return;
+
+        lua_pop(L, 1);
+        lua_pushcfunction(L, &handle);
+
+        lua_pushlightuserdata(L, key());
+        lua_pushvalue(L, -2);
+        lua_rawset(L, LUA_REGISTRYINDEX);
+    }
+
+    // error objects that are not strings are passed through unchanged
+    static int handle(lua_State* L)
+    {
+        if ( !lua_isstring(L, 1) )
+            return 1;
+
+        luaL_traceback(L, L, lua_tostring(L, 1), 1);
+        return 1;
+    }
+};
+
+// the C++ type a call returns for the result types R...: nothing, a single
+// value, or a tuple of values
+template<typename... R>
+struct Results
+{
+    using type = std::tuple<R...>;
+    static constexpr int count = TotalPushCount<R...>::value;
+};
+
+template<typename R>
+struct Results<R>
+{
+    using type = R;
+    static constexpr int count = PushCount<R>::value;
+};
+
+template<>
+struct Results<>
+{
+    using type = void;
+    static constexpr int count = 0;
+};
+
+// all of the results, left on the stack
+template<>
+struct Results<StackView>
+{
+    using type = StackView;
+    static constexpr int count = LUA_MULTRET;
+};
+
+// true if T (or an element of the tuple T) points into a lua string. such a
+// result dangles once the call's results are popped
+template<typename T>
+struct NonOwning : std::integral_constant<bool,
+    std::is_same<T, StringView>::value || std::is_same<T, const char*>::value> { };
+
+template<typename... Ts>
+struct AnyNonOwning : std::false_type { };
+
+template<typename T, typename... Ts>
+struct AnyNonOwning<T, Ts...> : std::integral_constant<bool,
+    NonOwning<T>::value || AnyNonOwning<Ts...>::value> { };
+
+template<typename... Ts>
+struct NonOwning<std::tuple<Ts...>> : AnyNonOwning<Ts...> { };
+
+// convert the results of a completed call, which start at index n, then
+// restore the stack to base. the results are popped, so they are converted to
+// owning types only (std::string rather than StringView or const char*)
+template<typename T>
+struct ResultReader
+{
+    static_assert(!NonOwning<T>::value,
+        "results are popped after the call: use std::string, or StackView to "
+        "keep them on the stack");
+
+    static T cast(lua_State* L, int n, int base)
+    {
+        T v = Ltl::cast<T>(L, n);
+        lua_settop(L, base);
+        return v;
+    }
+
+    static CallResult<T> try_cast(lua_State* L, int n, int base)
+    {
+        auto r = Ltl::try_cast<T>(L, n);
+        lua_settop(L, base);
+
+        if ( !r.ok )
+            return { T(), lua_errresult, "TypeError: unexpected result type" };
+
+        return { std::move(r.value), 0, std::string() };
+    }
+
+    static CallResult<T> unchecked(lua_State* L, int n, int base)
+    { return { cast(L, n, base), 0, std::string() }; }
+
+    static CallResult<T> error(int status, std::string message)
+    { return { T(), status, std::move(message) }; }
+};
+
+template<>
+struct ResultReader<void>
+{
+    static void cast(lua_State* L, int, int base)
+    { lua_settop(L, base); }
+
+    static CallResult<void> try_cast(lua_State* L, int, int base)
+    {
+        lua_settop(L, base);
+        return { 0, std::string() };
+    }
+
+    static CallResult<void> unchecked(lua_State* L, int n, int base)
+    { return try_cast(L, n, base); }
+
+    static CallResult<void> error(int status, std::string message)
+    { return { status, std::move(message) }; }
+};
+
+// the results stay on the stack, and the view covers them. anything between
+// base and the results (the message handler) is removed
+template<>
+struct ResultReader<StackView>
+{
+    static StackView cast(lua_State* L, int n, int base)
+    {
+        for ( ; n > base + 1; --n )
+            lua_remove(L, base + 1);
+
+        return StackView(L, n, lua_gettop(L));
+    }
+
+    static CallResult<StackView> try_cast(lua_State* L, int n, int base)
+    { return { cast(L, n, base), 0, std::string() }; }
+
+    static CallResult<StackView> unchecked(lua_State* L, int n, int base)
+    { return try_cast(L, n, base); }
+
+    static CallResult<StackView> error(int status, std::string message)
+    { return { StackView(), status, std::move(message) }; }
+};
+
+} // namespace detail
+
 class Func : public detail::Ref<Func>
 {
 public:
@@ -14,6 +223,56 @@ public:
 
     Func() : detail::Ref<Func>() { }
     Func(lua_State* L, int n) : detail::Ref<Func> { L, n } { }
+
+    // call the function with args, converting its results to R... (nothing,
+    // a single value or a std::tuple). lua errors are not caught. results
+    // are cast without checking
+    template<typename... R, typename... Args>
+    typename detail::Results<R...>::type call(Args&&... args) const
+    {
+        using results = detail::Results<R...>;
+
+        int base = lua_gettop(L);
+        luaL_checkstack(L, 1 + results::count + detail::push_scratch, "cannot call function");
+
+        lua_pushvalue(L, index());
+        int nargs = push_all(L, std::forward<Args>(args)...);
+        lua_call(L, nargs, results::count);
+
+        return detail::ResultReader<typename results::type>::cast(L, base + 1, base);
+    }
+
+    // call the function with args in protected mode. on failure, the result
+    // holds the lua status code and the error message with a traceback.
+    // results that cannot be converted to R... fail with lua_errresult
+    template<typename... R, typename... Args>
+    CallResult<typename detail::Results<R...>::type> pcall(Args&&... args) const
+    {
+        using results = detail::Results<R...>;
+        using reader = detail::ResultReader<typename results::type>;
+
+        int base = lua_gettop(L);
+        luaL_checkstack(L, 2 + results::count + detail::push_scratch, "cannot call function");
+
+        // the function is pushed first, as its index may be relative or a
+        // pseudo-index, and the handler is moved below it
+        lua_pushvalue(L, index());
+        detail::ErrorHandler::push(L);
+        lua_insert(L, base + 1);
+
+        int nargs = push_all(L, std::forward<Args>(args)...);
+
+        int status = lua_pcall(L, nargs, results::count, base + 1);
+        if ( status )
+        {
+            const char* message = lua_tostring(L, -1);
+            auto r = reader::error(status, message ? message : "(error object is not a string)");
+            lua_settop(L, base);
+            return r;
+        }
+
+        return reader::try_cast(L, base + 2, base);
+    }
 };
 
 }
@@ -0,0 +1,65 @@
+#ifndef LUA_KEY_H
+#define LUA_KEY_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <luajit-2.0/lua.hpp>
+
+#include "lua_persistent.h"
+
+namespace Ltl
+{
+
+// a string key interned once per lua_State. the string is anchored in the
+// registry, so pushing it is a single lua_rawgeti and it is never hashed
+// again. keys can be used wherever the table, field and global accessors take
+// a string:
+//
+//     Ltl::Key timeout(L, "timeout");
+//     int t = Ltl::get_field<int>(L, cfg, timeout);
+//
+// with get_field a Key only saves the hashing over a const char* key: it is
+// about as fast as lua_getfield. Table::get (a raw get) is faster.
+//
+// like Persistent, a Key must be destroyed before its lua_State is closed
+class Key
+{
+public:
+    using push_tag = detail::persistent_tag;
+
+    Key() : str { nullptr }, len { 0 } { }
+
+    Key(lua_State* L, const char* s, size_t n) : str { nullptr }, len { n }
+    {
+        lua_pushlstring(L, s, n);
+        str = lua_tostring(L, -1);
+        ref = PersistentRef(L, -1);
+        lua_pop(L, 1);
+    }
+
+    Key(lua_State* L, const char* s) : Key(L, s, std::strlen(s)) { }
+    Key(lua_State* L, const std::string& s) : Key(L, s.data(), s.size()) { }
+
+    bool valid() const
+    { return ref.valid(); }
+
+    void push(lua_State* L) const
+    { ref.push(L); }
+
+    // the interned lua string
+    const char* c_str() const
+    { return str; }
+
+    size_t size() const
+    { return len; }
+
+private:
+    PersistentRef ref;
+    const char* str;
+    size_t len;
+};
+
+}
+
+#endif
@@ -0,0 +1,261 @@
+#ifndef LUA_NUMBERS_H
+#define LUA_NUMBERS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <luajit-2.0/lua.hpp>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "lua_util.h"
+
+namespace Ltl
+{
+
+namespace detail
+{
+
+// values are moved between the lua table and the C++ buffer in blocks of
+// this many lua_Numbers
+static constexpr size_t number_block_size = 256;
+
+// floating point conversions are not range checked (they follow IEEE
+// rounding and overflow)
+template<typename T, typename Enable = void>
+struct NumberLimits
+{
+    static bool in_range(lua_Number)
+    { return true; }
+};
+
+// integer conversions truncate toward zero. values outside [lo, hi) are
+// rejected
+template<typename T>
+struct NumberLimits<T, typename std::enable_if<std::is_integral<T>::value>::type>
+{
+    static constexpr lua_Number lo()
+    { return static_cast<lua_Number>(std::numeric_limits<T>::min()); }
+
+    static constexpr lua_Number hi()
+    { return 2.0 * static_cast<lua_Number>(std::numeric_limits<T>::max() / 2 + 1); }
+
+    static bool in_range(lua_Number v)
+    { return v >= lo() && v < hi(); }
+};
+
+// convert a staged block of numbers. returns the number of leading values
+// that were converted (all n unless one is out of range)
+template<typename T>
+static inline size_t convert_scalar(const lua_Number* in, T* out, size_t n)
+{
+    for ( size_t i = 0; i < n; ++i )
+    {
+        if ( !NumberLimits<T>::in_range(in[i]) )
+            return i;
+
+        out[i] = static_cast<T>(in[i]);
+    }
+
+    return n;
+}
+
+// generic kernel. the validation and conversion passes have no early exits so
+// that the compiler can vectorize them
+template<typename T, typename Enable = void>
+struct NumberKernel
+{
+    static size_t convert(const lua_Number* in, T* out, size_t n)
+    {
+        unsigned bad = 0;
+        for ( size_t i = 0; i < n; ++i )
+            bad |= !NumberLimits<T>::in_range(in[i]);
+
+        if ( bad )
+            return convert_scalar(in, out, n);
+
+        for ( size_t i = 0; i < n; ++i )
+            out[i] = static_cast<T>(in[i]);
+
+        return n;
+    }
+};
+
+#if defined(__AVX__)
+
+template<>
+struct NumberKernel<float>
+{
+    static size_t convert(const lua_Number* in, float* out, size_t n)
+    {
+        size_t i = 0;
+        for ( ; i + 4 <= n; i += 4 )
+            _mm_storeu_ps(out + i, _mm256_cvtpd_ps(_mm256_loadu_pd(in + i)));
+
+        return i + convert_scalar(in + i, out + i, n - i);
+    }
+};
+
+template<>
+struct NumberKernel<int32_t>
+{
+    static size_t convert(const lua_Number* in, int32_t* out, size_t n)
+    {
+        const __m256d lo = _mm256_set1_pd(NumberLimits<int32_t>::lo());
+        const __m256d hi = _mm256_set1_pd(NumberLimits<int32_t>::hi());
+
+        size_t i = 0;
+        for ( ; i + 4 <= n; i += 4 )
+        {
+            __m256d v = _mm256_loadu_pd(in + i);
+            __m256d ok = _mm256_and_pd(
+                _mm256_cmp_pd(v, lo, _CMP_GE_OQ), _mm256_cmp_pd(v, hi, _CMP_LT_OQ));
+
+            // let the scalar tail find the offending value
+            if ( _mm256_movemask_pd(ok) != 0xf )
+                break;
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                _mm256_cvttpd_epi32(v));
+        }
+
+        return i + convert_scalar(in + i, out + i, n - i);
+    }
+};
+
+#elif defined(__SSE2__)
+
+template<>
+struct NumberKernel<float>
+{
+    static size_t convert(const lua_Number* in, float* out, size_t n)
+    {
+        size_t i = 0;
+        for ( ; i + 4 <= n; i += 4 )
+        {
+            __m128 a = _mm_cvtpd_ps(_mm_loadu_pd(in + i));
+            __m128 b = _mm_cvtpd_ps(_mm_loadu_pd(in + i + 2));
+            _mm_storeu_ps(out + i, _mm_movelh_ps(a, b));
+        }
+
+        return i + convert_scalar(in + i, out + i, n - i);
+    }
+};
+
+template<>
+struct NumberKernel<int32_t>
+{
+    static size_t convert(const lua_Number* in, int32_t* out, size_t n)
+    {
+        const __m128d lo = _mm_set1_pd(NumberLimits<int32_t>::lo());
+        const __m128d hi = _mm_set1_pd(NumberLimits<int32_t>::hi());
+
+        size_t i = 0;
+        for ( ; i + 2 <= n; i += 2 )
+        {
+            __m128d v = _mm_loadu_pd(in + i);
+            __m128d ok = _mm_and_pd(_mm_cmpge_pd(v, lo), _mm_cmplt_pd(v, hi));
+
+            // let the scalar tail find the offending value
+            if ( _mm_movemask_pd(ok) != 0x3 )
+                break;
+
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i),
+                _mm_cvttpd_epi32(v));
+        }
+
+        return i + convert_scalar(in + i, out + i, n - i);
+    }
+};
+
+#endif
+
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+// bulk numeric array transfer
+// -----------------------------------------------------------------------------
+
+// returned by read_numbers() when the value at idx is not a table
+static constexpr size_t not_a_table = static_cast<size_t>(-1);
+
+// read elements 1..n of the table at idx into out. returns the number of
+// leading elements converted. if this is less than n, lua element
+// (return value + 1) is not a number or is out of range for T. returns
+// not_a_table (and reads nothing) if idx is not a table
+template<typename T>
+static inline size_t read_numbers(lua_State* L, int idx, T* out, size_t n)
+{
+    using namespace detail;
+
+    if ( !lua_istable(L, idx) )
+        return not_a_table;
+
+    idx = util::abs_index(L, idx);
+    int top = lua_gettop(L);
+
+    luaL_checkstack(L, number_block_size, "too many values to read");
+
+    lua_Number staging[number_block_size];
+
+    for ( size_t base = 0; base < n; base += number_block_size )
+    {
+        size_t count = n - base < number_block_size ? n - base : number_block_size;
+
+        // the block is left on the stack and discarded in one call
+        size_t fetched = 0;
+        for ( ; fetched < count; ++fetched )
+        {
+            lua_rawgeti(L, idx, static_cast<int>(base + fetched + 1));
+            if ( lua_type(L, -1) != LUA_TNUMBER )
+                break;
+
+            staging[fetched] = lua_tonumber(L, -1);
+        }
+
+        lua_settop(L, top);
+
+        size_t converted = NumberKernel<T>::convert(staging, out + base, fetched);
+        if ( converted < count )
+            return base + converted;
+    }
+
+    return n;
+}
+
+// write in[0..n) to elements 1..n of the table at idx. returns false (and
+// writes nothing) if idx is not a table. each element takes a push and a
+// rawset, so there is no conversion kernel on this side
+template<typename T>
+static inline bool write_numbers(lua_State* L, int idx, const T* in, size_t n)
+{
+    if ( !lua_istable(L, idx) )
+        return false;
+
+    idx = util::abs_index(L, idx);
+
+    for ( size_t i = 0; i < n; ++i )
+    {
+        lua_pushnumber(L, static_cast<lua_Number>(in[i]));
+        lua_rawseti(L, idx, static_cast<int>(i + 1));
+    }
+
+    return true;
+}
+
+// push a new (presized) table holding in[0..n)
+template<typename T>
+static inline void push_numbers(lua_State* L, const T* in, size_t n)
+{
+    lua_createtable(L, static_cast<int>(n), 0);
+    write_numbers(L, -1, in, n);
+}
+
+}
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef LUA_PERSISTENT_H
+#define LUA_PERSISTENT_H
+
+#include <luajit-2.0/lua.hpp>
+
+#include "lua_stack_api.h"
+#include "lua_ref.h"
+#include "lua_function.h"
+#include "lua_table.h"
+
+namespace Ltl
+{
+
+namespace detail
+{
+
+struct persistent_tag {};
+
+template<>
+struct PushPolicy<persistent_tag>
+{
+    template<typename T>
+    static void push(lua_State* L, const T& v)
+    { v.push(L); }
+};
+
+} // namespace detail
+
+// an owning reference to a lua value, anchored in the registry with luaL_ref.
+// unlike a Ref, it remains valid after the stack slot it was created from is
+// gone (across calls into the VM, for example).
+//
+// released slots go back onto the registry's free list (luaL_unref), so
+// creating and destroying references does not grow the registry.
+//
+// a Persistent must be destroyed (or reset) before its lua_State is closed
+template<typename Handle>
+class Persistent
+{
+public:
+    using push_tag = detail::persistent_tag;
+
+    // default ctor creates an empty reference
+    Persistent() : L { nullptr }, id { LUA_NOREF } { }
+
+    // anchor the value at index n
+    Persistent(lua_State* L, int n) : L { L }
+    {
+        lua_pushvalue(L, n);
+        id = luaL_ref(L, LUA_REGISTRYINDEX);
+    }
+
+    // anchor the value referred to by h. an invalid handle gives an empty
+    // reference
+    explicit Persistent(const Handle& h) : Persistent()
+    {
+        if ( h.valid() )
+            *this = Persistent(h.state(), h.index());
+    }
+
+    Persistent(const Persistent&) = delete;
+    Persistent& operator=(const Persistent&) = delete;
+
+    Persistent(Persistent&& other) noexcept : L { other.L }, id { other.id }
+    {
+        other.L = nullptr;
+        other.id = LUA_NOREF;
+    }
+
+    Persistent& operator=(Persistent&& other) noexcept
+    {
+        if ( this != &other )
+        {
+            reset();
+            L = other.L;
+            id = other.id;
+            other.L = nullptr;
+            other.id = LUA_NOREF;
+        }
+
+        return *this;
+    }
+
+    ~Persistent()
+    { reset(); }
+
+    // release the registry slot
+    void reset()
+    {
+        if ( L )
+            luaL_unref(L, LUA_REGISTRYINDEX, id);
+
+        L = nullptr;
+        id = LUA_NOREF;
+    }
+
+    bool valid() const
+    { return L && id != LUA_NOREF; }
+
+    // the registry slot (LUA_REFNIL for nil, LUA_NOREF when empty)
+    int ref() const
+    { return id; }
+
+    lua_State* state() const
+    { return L; }
+
+    // push the value onto the stack of a state that shares a registry with
+    // the one the reference was created in (a coroutine, for example). pushes
+    // nil if the reference is empty
+    void push(lua_State* to) const
+    { lua_rawgeti(to, LUA_REGISTRYINDEX, id); }
+
+    // push onto the stack of the state the reference was created in. the
+    // reference must be valid
+    void push() const
+    { push(L); }
+
+    // push the value and return a handle to its stack slot
+    Handle get(lua_State* to) const
+    {
+        push(to);
+        return Handle(to, lua_gettop(to));
+    }
+
+    // the reference must be valid
+    Handle get() const
+    { return get(L); }
+
+private:
+    lua_State* L;
+    int id;
+};
+
+using PersistentRef = Persistent<Ref>;
+using PersistentFunc = Persistent<Func>;
+using PersistentTable = Persistent<Table>;
+
+}
+
+#endif
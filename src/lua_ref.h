@@ -1,6 +1,8 @@
 #ifndef LUA_REF_H
 #define LUA_REF_H
 
+#include <type_traits>
+
 #include "lua_stack_api.h"
 #include "lua_util.h"
 
@@ -57,8 +59,8 @@ template<>
 struct NamePolicy<generic_tag>
 {
     template<typename T>
-    static std::string name(lua_State* L, int n)
-    { return "Ref@" + std::to_string(util::abs_index(L, n)); }
+    static const char* name(lua_State*, int)
+    { return "Ref"; }
 };
 
 // Ref itself should use the TypePolicy<generic_tag>, but we want its
@@ -87,11 +89,14 @@ public:
     Ref(lua_State* L, int n) :
         L { L }, n { n } { }
 
-    virtual int index() const
+    int index() const
     { return n; }
 
-    virtual bool valid() const
-    { return L && n && type<self_type>(L, index()); }
+    lua_State* state() const
+    { return L; }
+
+    bool valid() const
+    { return L && n && type<self_type>(L, self().index()); }
 
     // manually cause ref to be invalid
     void invalidate()
@@ -99,19 +104,21 @@ public:
 
     // convenience functions, only enabled on the generic ref
     template<typename T>
-    bool is();
+    bool is() const;
 
     template<typename T>
-    T to();
+    T to() const;
 
     // convenience overload for conversion
     template<typename T>
-    operator T();
+    operator T() const;
 
 protected:
     lua_State* L;
     int n;
 
+    // handles are dispatched statically: members that depend on the handle
+    // type go through self() rather than virtual functions
     using self_type =
         typename std::conditional<
             std::is_void<Subclass>::value,
@@ -119,32 +126,30 @@ protected:
             Subclass
         >::type;
 
-    // FIXIT-H: Unused, delete this
-    using parent_type = 
-        typename std::conditional<
-            std::is_void<Subclass>::value,
-            void,
-            Ref<Subclass>
-        >::type;
-
+    const self_type& self() const
+    { return static_cast<const self_type&>(*this); }
 };
 
+// handles are passed by value, so keep them small enough to travel in registers
+static_assert(std::is_trivially_copyable<Ref<>>::value, "Ref must be trivially copyable");
+static_assert(sizeof(Ref<>) <= 16, "Ref must fit in two registers");
+
 // only enable the is() function for Ref<void>
 template<>
 template<typename T>
-bool Ref<void>::is()
+bool Ref<void>::is() const
 { return type<T>(L, index()); }
 
 // only enable to to() function for Ref<void>
 template<>
 template<typename T>
-T Ref<void>::to()
+T Ref<void>::to() const
 { return cast<T>(L, index()); }
 
 // only enable the conversion operator for Ref<void>
 template<>
 template<typename T>
-Ref<void>::operator T()
+Ref<void>::operator T() const
 {
     // FIXIT-H for safety, this should either call Ltl::check(), or Ltl::get()
     // otherwise, type checking will become necessary, and the benefit of this
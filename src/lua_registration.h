@@ -9,6 +9,7 @@
 
 #include "lua_userdata.h"
 #include "lua_registration_helpers.h"
+#include "lua_stack_guard.h"
 
 namespace Ltl
 {
@@ -17,6 +18,8 @@ namespace detail
 {
 static inline int new_lib(lua_State* L, std::string libname)
 {
+    StackGuard guard(L, libname.c_str(), 1);
+
     static const luaL_reg empty_lib[] = { { nullptr, nullptr } };
     luaL_register(L, libname.c_str(), empty_lib);
     return lua_gettop(L);
@@ -24,6 +27,8 @@ static inline int new_lib(lua_State* L, std::string libname)
 
 static inline int new_metalib(lua_State* L, std::string libname)
 {
+    StackGuard guard(L, libname.c_str(), 1);
+
     luaL_newmetatable(L, libname.c_str());
     return lua_gettop(L);
 }
@@ -33,7 +38,9 @@ static inline int new_metalib(lua_State* L, std::string libname)
 enum class PropertyAccess
 { READ_WRITE, READ_ONLY, WRITE_ONLY };
 
-template<typename Class>
+// Mode selects how the arguments of bound functions are checked (see
+// Ltl::Checked and Ltl::Trusted)
+template<typename Class, typename Mode = DefaultMode>
 class ClassRegistrar
 {
 public:
@@ -41,6 +48,15 @@ public:
         L { L_ }, name { n }, closed { false }
     { open(); }
 
+    // only the last owner closes the registration
+    ClassRegistrar(ClassRegistrar&& other) :
+        L { other.L }, name { std::move(other.name) }, closed { other.closed },
+        methods { other.methods }, meta { other.meta }
+    { other.closed = true; }
+
+    ClassRegistrar(const ClassRegistrar&) = delete;
+    ClassRegistrar& operator=(const ClassRegistrar&) = delete;
+
     ~ClassRegistrar()
     {
         if ( !closed )
@@ -53,13 +69,15 @@ public:
     template<typename... Pack>
     ClassRegistrar& add_ctor()
     {
-        detail::AutoCtorHelper<Class, Pack...>::push(L, methods);
+        StackGuard guard(L, "new");
+        detail::AutoCtorHelper<Mode, Class, Pack...>::push(L, methods);
         return *this;
     }
 
     template<typename F>
     ClassRegistrar& add_ctor(F&& fn)
     {
+        StackGuard guard(L, "new");
         detail::CustomCtorHelper<Class, F>::push(L, methods, fn);
         return *this;
     }
@@ -68,28 +86,105 @@ public:
     ClassRegistrar& add_dtor(F&&)
     { return *this; }
 
+    // a functor taking (Ltl::Arg&, Class*)
     template<typename F>
-    ClassRegistrar& add_function(std::string, F&&)
-    { return *this; }
+    ClassRegistrar& add_function(std::string fname, F&& fn)
+    {
+        StackGuard guard(L, fname.c_str());
+        detail::FunctorMethodHelper<Mode, Class, typename std::decay<F>::type>::push(
+            L, methods, fname, std::forward<F>(fn));
+
+        return *this;
+    }
+
+    template<typename Ret, typename... Pack>
+    ClassRegistrar& add_function(std::string fname, Ret (Class::*fn)(Pack...))
+    {
+        StackGuard guard(L, fname.c_str());
+        detail::MethodHelper<Mode, Class, decltype(fn), Ret, Pack...>::push(
+            L, methods, fname, fn);
+
+        return *this;
+    }
+
+    template<typename Ret, typename... Pack>
+    ClassRegistrar& add_function(std::string fname, Ret (Class::*fn)(Pack...) const)
+    {
+        StackGuard guard(L, fname.c_str());
+        detail::MethodHelper<Mode, Class, decltype(fn), Ret, Pack...>::push(
+            L, methods, fname, fn);
+
+        return *this;
+    }
+
+    template<typename Ret, typename... Pack, typename... Ds>
+    ClassRegistrar& add_function(
+        std::string fname, Ret (Class::*fn)(Pack...), Defaults<Ds...> d)
+    {
+        StackGuard guard(L, fname.c_str());
+        detail::MethodHelper<Mode, Class, decltype(fn), Ret, Pack...>::push(
+            L, methods, fname, fn, std::move(d));
+
+        return *this;
+    }
+
+    template<typename Ret, typename... Pack, typename... Ds>
+    ClassRegistrar& add_function(
+        std::string fname, Ret (Class::*fn)(Pack...) const, Defaults<Ds...> d)
+    {
+        StackGuard guard(L, fname.c_str());
+        detail::MethodHelper<Mode, Class, decltype(fn), Ret, Pack...>::push(
+            L, methods, fname, fn, std::move(d));
+
+        return *this;
+    }
 
     template<typename F>
     ClassRegistrar& add_static_function(std::string, F&&)
     { return *this; }
 
+    template<typename Ret, typename... Pack>
+    ClassRegistrar& add_static_function(std::string fname, Ret (*fn)(Pack...))
+    {
+        StackGuard guard(L, fname.c_str());
+        detail::FunctionHelper<Mode, Ret, Pack...>::push(L, methods, fname, fn);
+        return *this;
+    }
+
+    template<typename Ret, typename... Pack, typename... Ds>
+    ClassRegistrar& add_static_function(
+        std::string fname, Ret (*fn)(Pack...), Defaults<Ds...> d)
+    {
+        StackGuard guard(L, fname.c_str());
+        detail::FunctionHelper<Mode, Ret, Pack...>::push(
+            L, methods, fname, fn, std::move(d));
+
+        return *this;
+    }
+
 private:
     void add_default_dtor()
-    { detail::AutoDtorHelper<Class>::push(L, meta); }
+    {
+        StackGuard guard(L, "__gc");
+        detail::AutoDtorHelper<Class>::push(L, meta);
+    }
 
+    // leaves the methods table and the metatable on the stack until close()
     void open()
     {
+        StackGuard guard(L, name.c_str(), 2);
+
         Userdata<Class>::set_type_name(name);
         methods = detail::new_lib(L, name);
         meta = detail::new_metalib(L, name);
+        detail::cache_metatable<Userdata<Class>>(L, meta);
         add_default_dtor();
     }
 
     void close()
     {
+        StackGuard guard(L, name.c_str(), -2);
+
         lua_pushstring(L, "__index");
         lua_pushvalue(L, methods);
         lua_rawset(L, meta);
@@ -97,6 +192,10 @@ private:
         lua_pushstring(L, "__metatable");
         lua_pushvalue(L, methods);
         lua_rawset(L, meta);
+
+        // meta is above methods
+        lua_remove(L, meta);
+        lua_remove(L, methods);
     }
 
     lua_State* L;
@@ -136,9 +235,9 @@ private:
 
 
 
-template<typename T>
-ClassRegistrar<T> register_class(lua_State* L, std::string name)
-{ return ClassRegistrar<T>(L, name); }
+template<typename T, typename Mode = DefaultMode>
+ClassRegistrar<T, Mode> register_class(lua_State* L, std::string name)
+{ return ClassRegistrar<T, Mode>(L, name); }
 
 } // namespace Ltl
 
@@ -1,21 +1,44 @@
 #ifndef LUA_REGISTRATION_HELPERS_H
 #define LUA_REGISTRATION_HELPERS_H
 
+#include <functional>
 #include <iostream>
 #include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <luajit-2.0/lua.hpp>
+#include "lua_arg.h"
+#include "lua_exception.h"
 #include "lua_stack_api.h"
 #include "lua_userdata.h"
 #include "lua_sandbox.h"
+#include "lua_stack_guard.h"
+#include "lua_tuple.h"
 
 namespace Ltl
 {
 
+// default values for the trailing parameters of a bound function. they are
+// used when the corresponding argument is none or nil:
+//
+//     .add_function("connect", &Conn::connect, Ltl::defaults(80, 30.0))
+template<typename... Ts>
+struct Defaults
+{
+    static constexpr size_t size = sizeof...(Ts);
+    std::tuple<Ts...> values;
+};
+
+template<typename... Ts>
+static inline Defaults<typename std::decay<Ts>::type...> defaults(Ts&&... vs)
+{ return { std::make_tuple(std::forward<Ts>(vs)...) }; }
+
 namespace detail
 {
 
 template<typename T>
-static inline std::string get_ud_type_name()
+static inline const std::string& get_ud_type_name()
 { return Userdata<T>::get_type_name(); }
 
 template<typename T>
@@ -72,6 +95,9 @@ template<typename F>
 static inline void push_function(
     lua_State* L, std::string name, int table, F&& fn, int nup = 0)
 {
+    // the upvalues are consumed
+    StackGuard guard(L, name.c_str(), -nup);
+
     push(L, fn, nup);
     push(L, name);
 
@@ -84,13 +110,38 @@ static inline void push_function(
 // argument appliers
 // -----------------------------------------------------------------------------
 
+// the type a parameter is checked as. parameters are checked by value, and
+// pointers to classes are checked as userdata
+template<typename T, typename Enable = void>
+struct ArgType
+{ using type = typename std::decay<T>::type; };
+
+template<typename T>
+struct ArgType<T, typename std::enable_if<
+    std::is_pointer<typename std::decay<T>::type>::value &&
+    std::is_class<typename std::remove_pointer<
+        typename std::decay<T>::type>::type>::value
+    >::type>
+{
+    using type = typename std::remove_cv<typename std::remove_pointer<
+        typename std::decay<T>::type>::type>::type;
+};
+
+template<typename T>
+struct ArgType<Opt<T>>
+{ using type = Opt<typename ArgType<T>::type>; };
+
+template<typename T>
+using arg_t = typename ArgType<T>::type;
+
+
 template<int N, typename Ret, typename... Pack>
 struct ArgumentApplier {};
 
 template<int N, typename Ret>
 struct ArgumentApplier<N, Ret>
 {
-    template<typename F, typename... Args>
+    template<typename Mode = DefaultMode, typename F, typename... Args>
     static Ret apply(lua_State*, F fn, Args&&... args)
     { return fn(std::forward<Args>(args)...); }
 };
@@ -98,11 +149,121 @@ struct ArgumentApplier<N, Ret>
 template<int N, typename Ret, typename Next, typename... Rest>
 struct ArgumentApplier<N, Ret, Next, Rest...>
 {
-    template<typename F, typename... Args>
+    template<typename Mode = DefaultMode, typename F, typename... Args>
     static Ret apply(lua_State* L, F fn, Args&&... args)
     {
-        return ArgumentApplier<N+1, Ret, Rest...>::apply(L, fn,
-            std::forward<Args>(args)..., check<Next>(L, N));
+        return ArgumentApplier<N+1, Ret, Rest...>::template apply<Mode>(L, fn,
+            std::forward<Args>(args)...,
+            ArgPolicy<Mode>::template get<arg_t<Next>>(L, N));
+    }
+};
+
+// arguments at lua index First and above have a default value (element
+// N - First of the Defaults), which is used when the slot is none or nil
+template<int I, typename T, typename Enable = void>
+struct DefaultArg
+{
+    template<typename Mode, typename D>
+    static userdata_wrapped_t<arg_t<T>> get(lua_State* L, int n, const D&)
+    { return ArgPolicy<Mode>::template get<arg_t<T>>(L, n); }
+};
+
+template<int I, typename T>
+struct DefaultArg<I, T, typename std::enable_if<(I >= 0)>::type>
+{
+    template<typename Mode, typename D>
+    static typename std::decay<T>::type get(lua_State* L, int n, const D& d)
+    {
+        if ( lua_isnoneornil(L, n) )
+            return std::get<I>(d.values);
+
+        return ArgPolicy<Mode>::template get<arg_t<T>>(L, n);
+    }
+};
+
+template<int N, int First, typename Ret, typename... Pack>
+struct DefaultArgumentApplier {};
+
+template<int N, int First, typename Ret>
+struct DefaultArgumentApplier<N, First, Ret>
+{
+    template<typename Mode, typename D, typename F, typename... Args>
+    static Ret apply(lua_State*, const D&, F fn, Args&&... args)
+    { return fn(std::forward<Args>(args)...); }
+};
+
+template<int N, int First, typename Ret, typename Next, typename... Rest>
+struct DefaultArgumentApplier<N, First, Ret, Next, Rest...>
+{
+    template<typename Mode, typename D, typename F, typename... Args>
+    static Ret apply(lua_State* L, const D& d, F fn, Args&&... args)
+    {
+        return DefaultArgumentApplier<N+1, First, Ret, Rest...>::template apply<Mode>(
+            L, d, fn, std::forward<Args>(args)...,
+            DefaultArg<N - First, Next>::template get<Mode>(L, N, d));
+    }
+};
+
+// C functions are entered with LUA_MINSTACK free slots. bound calls whose
+// results need more reserve them once, on entry, before any conversion
+template<typename Ret>
+static inline void reserve_results(lua_State* L)
+{
+    constexpr int count =
+        PushCount<typename std::decay<Ret>::type>::value + push_scratch;
+
+    if ( count > LUA_MINSTACK )
+        luaL_checkstack(L, count, "too many results");
+}
+
+template<int N, typename D, typename... Pack>
+struct first_default
+{
+    static_assert(D::size <= sizeof...(Pack), "more defaults than parameters");
+    static constexpr int value = N + sizeof...(Pack) - D::size;
+};
+
+// apply arguments to fn and push its result. returns the number of values
+// pushed
+template<int N, typename Ret, typename... Pack>
+struct ResultApplier
+{
+    template<typename Mode = DefaultMode, typename F>
+    static int apply(lua_State* L, F fn)
+    {
+        reserve_results<Ret>(L);
+        push(L, ArgumentApplier<N, Ret, Pack...>::template apply<Mode>(L, fn));
+        return PushCount<typename std::decay<Ret>::type>::value;
+    }
+
+    template<typename Mode = DefaultMode, typename D, typename F>
+    static int apply(lua_State* L, const D& d, F fn)
+    {
+        reserve_results<Ret>(L);
+        push(L, DefaultArgumentApplier<N, first_default<N, D, Pack...>::value,
+            Ret, Pack...>::template apply<Mode>(L, d, fn));
+
+        return PushCount<typename std::decay<Ret>::type>::value;
+    }
+};
+
+template<int N, typename... Pack>
+struct ResultApplier<N, void, Pack...>
+{
+    template<typename Mode = DefaultMode, typename F>
+    static int apply(lua_State* L, F fn)
+    {
+        ArgumentApplier<N, void, Pack...>::template apply<Mode>(L, fn);
+        return 0;
+    }
+
+    template<typename Mode = DefaultMode, typename D, typename F>
+    static int apply(lua_State* L, const D& d, F fn)
+    {
+        DefaultArgumentApplier<N, first_default<N, D, Pack...>::value,
+            void, Pack...>::template apply<Mode>(L, d, fn);
+
+        return 0;
     }
 };
 
@@ -115,7 +276,7 @@ struct NewArgumentApplier {};
 template<int N, typename Class>
 struct NewArgumentApplier<N, Class>
 {
-    template<typename... Args>
+    template<typename Mode = DefaultMode, typename... Args>
     static Class* apply(lua_State*, Args&&... args)
     { return new Class(std::forward<Args>(args)...); }
 };
@@ -123,11 +284,12 @@ struct NewArgumentApplier<N, Class>
 template<int N, typename Class, typename Next, typename... Rest>
 struct NewArgumentApplier<N, Class, Next, Rest...>
 {
-    template<typename... Args>
+    template<typename Mode = DefaultMode, typename... Args>
     static Class* apply(lua_State* L, Args&&... args)
     {
-        return NewArgumentApplier<N+1, Class, Rest...>::apply(L,
-            std::forward<Args>(args)..., check<Next>(L, N));
+        return NewArgumentApplier<N+1, Class, Rest...>::template apply<Mode>(L,
+            std::forward<Args>(args)...,
+            ArgPolicy<Mode>::template get<arg_t<Next>>(L, N));
     }
 };
 
@@ -138,7 +300,7 @@ struct CtorArgApplier {};
 template<int N, typename Class>
 struct CtorArgApplier<N, Class>
 {
-    template<typename... Args>
+    template<typename Mode = DefaultMode, typename... Args>
     static Class* apply(lua_State*, Args&&... args)
     { return new Class(std::forward<Args>(args)...); }
 };
@@ -146,11 +308,12 @@ struct CtorArgApplier<N, Class>
 template<int N, typename Class, typename Next, typename... Rest>
 struct CtorArgApplier<N, Class, Next, Rest...>
 {
-    template<typename... Args>
+    template<typename Mode = DefaultMode, typename... Args>
     static Class* apply(lua_State* L, Args&&... args)
     {
-        return CtorArgApplier<N+1, Class, Rest...>::apply(
-            L, std::forward<Args>(args)..., check<Next>(L, N));
+        return CtorArgApplier<N+1, Class, Rest...>::template apply<Mode>(
+            L, std::forward<Args>(args)...,
+            ArgPolicy<Mode>::template get<arg_t<Next>>(L, N));
     }
 };
 
@@ -178,6 +341,7 @@ struct GCObject
     static T** create(lua_State* L)
     {
         // FIXIT-H add some error checking
+        StackGuard guard(L, "GCObject::create", 1);
 
         // Create a new userdata
         auto handle = alloc_ud_handle<T>(L);
@@ -208,6 +372,25 @@ struct GCObject
 // proxy wrappers
 // -----------------------------------------------------------------------------
 
+// run the body of a proxy, converting exceptions into a lua error. the error
+// is raised after the exception has been destroyed. in debug builds the body
+// must push exactly the results it returns
+template<typename F>
+static inline int protect(lua_State* L, F fn)
+{
+    try
+    {
+        StackGuard guard(L, nullptr, StackGuard::result_count);
+        return guard.results(fn());
+    }
+    catch ( Exception& e )
+    {
+        lua_pushstring(L, e.what());
+    }
+
+    return lua_error(L);
+}
+
 using raw_fn_t = lua_CFunction;
 using raw_functor_t = std::function<int(lua_State*)>;
 
@@ -217,12 +400,15 @@ using wrapped_ctor_fn_t = Class*(*)(Sandbox&);
 template<typename Class>
 using wrapped_ctor_functor_t = std::function<Class*(Sandbox&)>;
 
-template<typename Class, typename... Pack>
+template<typename Mode, typename Class, typename... Pack>
 struct AutoCtorProxy
 {
     static int proxy(lua_State* L)
+    { return protect(L, [L]() { return construct(L); }); }
+
+    static int construct(lua_State* L)
     {
-        auto p = NewArgumentApplier<1, Class, Pack...>::apply(L);
+        auto p = NewArgumentApplier<1, Class, Pack...>::template apply<Mode>(L);
         assert(p);
 
         auto h = alloc_ud_handle<Class>(L);
@@ -230,7 +416,7 @@ struct AutoCtorProxy
 
         *h = p;
 
-        luaL_getmetatable(L, get_ud_type_name<Class>().c_str());
+        push_metatable<Userdata<Class>>(L);
         assert(lua_istable(L, -1));
         lua_setmetatable(L, -2);
 
@@ -238,11 +424,11 @@ struct AutoCtorProxy
     }
 };
 
-template<typename Class, typename... Pack>
+template<typename Mode, typename Class, typename... Pack>
 struct AutoCtorHelper
 {
     static void push(lua_State* L, int table)
-    { push_function(L, "new", table, &AutoCtorProxy<Class, Pack...>::proxy); }
+    { push_function(L, "new", table, &AutoCtorProxy<Mode, Class, Pack...>::proxy); }
 };
 
 template<typename Class, typename F>
@@ -267,7 +453,9 @@ struct CustomCtorProxy<Class, raw_functor_t>
     static int proxy(lua_State* L)
     {
         auto& fn = **get_ud_handle<raw_functor_t>(L, lua_upvalueindex(1));
-        return fn(L);
+
+        StackGuard guard(L, nullptr, StackGuard::result_count);
+        return guard.results(fn(L));
     }
 };
 
@@ -313,18 +501,185 @@ struct CustomCtorHelper<Class, wrapped_ctor_fn_t<Class>>
     }
 };
 
+// member functions. the member function pointer is stored in a userdata
+// upvalue and the object is taken from argument 1
+template<typename Mode, typename Class, typename F, typename Ret, typename... Pack>
+struct MethodProxy
+{
+    static int proxy(lua_State* L)
+    { return protect(L, [L]() { return call(L); }); }
+
+    static int call(lua_State* L)
+    {
+        F fn = *get_ud_ptr<F>(L, lua_upvalueindex(1));
+        Class* self = SelfPolicy::get<Class>(L, 1);
+
+        return ResultApplier<2, Ret, Pack...>::template apply<Mode>(L,
+            [self, fn](Pack... args) -> Ret
+            { return (self->*fn)(std::forward<Pack>(args)...); });
+    }
+};
+
+// a bound function together with its default arguments. held by a GCObject
+// upvalue, since the defaults may need to be destroyed
+template<typename F, typename D>
+struct Binding
+{
+    F fn;
+    D defaults;
+};
+
+template<typename Mode, typename Class, typename F, typename D, typename Ret,
+    typename... Pack>
+struct DefaultsMethodProxy
+{
+    static int proxy(lua_State* L)
+    { return protect(L, [L]() { return call(L); }); }
+
+    static int call(lua_State* L)
+    {
+        const auto& b = **GCObject<Binding<F, D>>::get(L, lua_upvalueindex(1));
+        F fn = b.fn;
+        Class* self = SelfPolicy::get<Class>(L, 1);
+
+        return ResultApplier<2, Ret, Pack...>::template apply<Mode>(L, b.defaults,
+            [self, fn](Pack... args) -> Ret
+            { return (self->*fn)(std::forward<Pack>(args)...); });
+    }
+};
+
+template<typename Mode, typename Class, typename F, typename Ret, typename... Pack>
+struct MethodHelper
+{
+    static void push(lua_State* L, int table, const std::string& name, F fn)
+    {
+        *alloc_ud_ptr<F>(L) = fn;
+        push_function(L, name, table,
+            &MethodProxy<Mode, Class, F, Ret, Pack...>::proxy, 1);
+    }
+
+    template<typename D>
+    static void push(lua_State* L, int table, const std::string& name, F fn, D d)
+    {
+        *GCObject<Binding<F, D>>::create(L) = new Binding<F, D> { fn, std::move(d) };
+        push_function(L, name, table,
+            &DefaultsMethodProxy<Mode, Class, F, D, Ret, Pack...>::proxy, 1);
+    }
+};
+
+// functors taking (Ltl::Arg&, Class*). the functor is held by a GCObject
+// upvalue and its arguments are read through an Arg starting after self
+template<typename F, typename Class, typename Enable = void>
+struct is_arg_method : std::false_type {};
+
+template<typename F, typename Class>
+struct is_arg_method<F, Class, decltype(void(
+    std::declval<F&>()(std::declval<Arg&>(), std::declval<Class*>())))> :
+    std::true_type {};
+
+template<typename Mode, typename Class, typename F>
+struct ArgMethodProxy
+{
+    using ret_t = decltype(std::declval<F&>()(std::declval<Arg&>(), std::declval<Class*>()));
+
+    static int proxy(lua_State* L)
+    { return protect(L, [L]() { return call(L); }); }
+
+    static int call(lua_State* L)
+    {
+        auto& fn = **GCObject<F>::get(L, lua_upvalueindex(1));
+        Class* self = SelfPolicy::get<Class>(L, 1);
+        Arg arg(L, 2);
+
+        return ResultApplier<2, ret_t>::template apply<Mode>(L,
+            [&fn, &arg, self]() -> ret_t { return fn(arg, self); });
+    }
+};
+
+// other functors are not supported yet and are ignored
+template<typename Mode, typename Class, typename F, typename Enable = void>
+struct FunctorMethodHelper
+{
+    static void push(lua_State*, int, const std::string&, F)
+    { }
+};
+
+template<typename Mode, typename Class, typename F>
+struct FunctorMethodHelper<Mode, Class, F,
+    typename std::enable_if<is_arg_method<F, Class>::value>::type>
+{
+    static void push(lua_State* L, int table, const std::string& name, F fn)
+    {
+        *GCObject<F>::create(L) = new F(std::move(fn));
+        push_function(L, name, table, &ArgMethodProxy<Mode, Class, F>::proxy, 1);
+    }
+};
+
+// free (static) functions
+template<typename Mode, typename Ret, typename... Pack>
+struct FunctionProxy
+{
+    using fn_t = Ret (*)(Pack...);
+
+    static int proxy(lua_State* L)
+    { return protect(L, [L]() { return call(L); }); }
+
+    static int call(lua_State* L)
+    {
+        fn_t fn = *get_ud_ptr<fn_t>(L, lua_upvalueindex(1));
+        return ResultApplier<1, Ret, Pack...>::template apply<Mode>(L, fn);
+    }
+};
+
+template<typename Mode, typename D, typename Ret, typename... Pack>
+struct DefaultsFunctionProxy
+{
+    using fn_t = Ret (*)(Pack...);
+
+    static int proxy(lua_State* L)
+    { return protect(L, [L]() { return call(L); }); }
+
+    static int call(lua_State* L)
+    {
+        const auto& b = **GCObject<Binding<fn_t, D>>::get(L, lua_upvalueindex(1));
+        return ResultApplier<1, Ret, Pack...>::template apply<Mode>(L, b.defaults, b.fn);
+    }
+};
+
+template<typename Mode, typename Ret, typename... Pack>
+struct FunctionHelper
+{
+    using fn_t = Ret (*)(Pack...);
+
+    static void push(lua_State* L, int table, const std::string& name, fn_t fn)
+    {
+        *alloc_ud_ptr<fn_t>(L) = fn;
+        push_function(L, name, table, &FunctionProxy<Mode, Ret, Pack...>::proxy, 1);
+    }
+
+    template<typename D>
+    static void push(lua_State* L, int table, const std::string& name, fn_t fn, D d)
+    {
+        *GCObject<Binding<fn_t, D>>::create(L) = new Binding<fn_t, D> { fn, std::move(d) };
+        push_function(L, name, table,
+            &DefaultsFunctionProxy<Mode, D, Ret, Pack...>::proxy, 1);
+    }
+};
+
 template<typename Class>
 struct AutoDtorProxy
 {
     static int proxy(lua_State* L)
     {
+        StackGuard guard(L, "__gc", StackGuard::result_count);
+
         auto h = check_ud_handle<Class>(L, 1);
         assert(h && *h); // dtor should not be called twice
 
         delete *h;
         *h = nullptr;
 
-        return 0;
+        return guard.results(0);
     }
 };
 
@@ -1,6 +1,7 @@
 #ifndef LUA_SANDBOX_H
 #define LUA_SANDBOX_H
 
+#include <utility>
 #include <luajit-2.0/lua.hpp>
 #include "lua_exception.h"
 #include "lua_userdata.h"
@@ -41,10 +42,11 @@ struct CheckPolicy
     template<typename T>
     static T check(lua_State* L, int n)
     {
-        if ( !type<T>(L, n) )
-            throw TypeError(name<T>(L, n), lua_typename(L, lua_type(L, n)));
+        auto r = try_cast<T>(L, n);
+        if ( !r.ok )
+            throw TypeError(n, name<T>(L, n), lua_type(L, n));
 
-        return cast<T>(L, n);
+        return std::move(r.value);
     }
 };
 
@@ -57,13 +59,11 @@ struct CheckPolicy<userdata_tag>
     template<typename T>
     static userdata_wrapped_t<T> check(lua_State* L, int n)
     {
-        if ( !type<userdata_wrapped_t<T>>(L, n) )
-            throw TypeError(
-                name<userdata_wrapped_t<T>>(L, n),
-                lua_typename(L, lua_type(L, n))
-            );
+        auto r = try_cast<userdata_wrapped_t<T>>(L, n);
+        if ( !r.ok )
+            throw TypeError(n, name<userdata_wrapped_t<T>>(L, n), lua_type(L, n));
 
-        return cast<userdata_wrapped_t<T>>(L, n);
+        return r.value;
     }
 };
 
@@ -76,6 +76,151 @@ static inline detail::userdata_wrapped_t<T> check(lua_State* L, int n)
     return CheckPolicy<typename CheckTrait<T>::tag>::template check<T>(L, n);
 }
 
+// -----------------------------------------------------------------------------
+// optional arguments
+// -----------------------------------------------------------------------------
+
+// an argument that may be omitted. none and nil check as an empty Opt;
+// any other value must check as T
+template<typename T>
+class Opt
+{
+public:
+    using value_type = T;
+
+    Opt() : v(), present { false } { }
+    Opt(T v) : v(std::move(v)), present { true } { }
+
+    template<typename U>
+    Opt(Opt<U>&& o) :
+        v(o ? T(std::move(o.value())) : T()), present { bool(o) } { }
+
+    explicit operator bool() const
+    { return present; }
+
+    T& value()
+    { return v; }
+
+    const T& value() const
+    { return v; }
+
+    T value_or(T d) const
+    { return present ? v : d; }
+
+    T& operator*()
+    { return v; }
+
+    T* operator->()
+    { return &v; }
+
+private:
+    T v;
+    bool present;
+};
+
+namespace detail
+{
+
+struct opt_tag {};
+
+template<typename T>
+struct CheckTrait<Opt<T>>
+{ using tag = opt_tag; };
+
+template<typename T>
+struct add_userdata_wrapper<Opt<T>>
+{ using type = Opt<userdata_wrapped_t<T>>; };
+
+template<>
+struct CheckPolicy<opt_tag>
+{
+    template<typename T>
+    static userdata_wrapped_t<T> check(lua_State* L, int n)
+    {
+        if ( lua_isnoneornil(L, n) )
+            return {};
+
+        return Ltl::check<typename T::value_type>(L, n);
+    }
+};
+
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+// argument checking modes
+// -----------------------------------------------------------------------------
+
+// Checked validates each argument of a bound function and raises a TypeError
+// on mismatch. Trusted casts arguments without validation (except the object
+// a method is called on), for scripts that are shipped with the host. builds
+// without NDEBUG check in both modes
+struct Checked {};
+struct Trusted {};
+
+#ifdef LTL_TRUSTED
+using DefaultMode = Trusted;
+#else
+using DefaultMode = Checked;
+#endif
+
+namespace detail
+{
+
+template<typename Mode>
+struct ArgPolicy
+{
+    template<typename T>
+    static userdata_wrapped_t<T> get(lua_State* L, int n)
+    { return Ltl::check<T>(L, n); }
+};
+
+// unchecked counterparts of the check policies
+template<typename Tag>
+struct TrustedPolicy
+{
+    template<typename T>
+    static userdata_wrapped_t<T> get(lua_State* L, int n)
+    { return cast<userdata_wrapped_t<T>>(L, n); }
+};
+
+template<>
+struct TrustedPolicy<opt_tag>
+{
+    template<typename T>
+    static userdata_wrapped_t<T> get(lua_State* L, int n)
+    {
+        using value_type = typename T::value_type;
+
+        if ( lua_isnoneornil(L, n) )
+            return {};
+
+        return TrustedPolicy<typename CheckTrait<value_type>::tag>::
+            template get<value_type>(L, n);
+    }
+};
+
+#ifdef NDEBUG
+template<>
+struct ArgPolicy<Trusted>
+{
+    template<typename T>
+    static userdata_wrapped_t<T> get(lua_State* L, int n)
+    { return TrustedPolicy<typename CheckTrait<T>::tag>::template get<T>(L, n); }
+};
+#endif
+
+// the object a method is called on is checked in every mode. a script that
+// writes obj.method(x) rather than obj:method(x) would otherwise have x cast to
+// the class, and only the remaining arguments are trusted
+struct SelfPolicy
+{
+    template<typename Class>
+    static Class* get(lua_State* L, int n)
+    { return ArgPolicy<Checked>::template get<Class>(L, n); }
+};
+
+} // namespace detail
+
 // FIXIT-H implement this
 class Sandbox {};
 
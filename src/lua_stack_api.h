@@ -2,6 +2,7 @@
 #define LUA_STACK_API_H
 
 #include <string>
+#include <type_traits>
 #include <utility>
 
 #include "lua_exception.h"
@@ -19,11 +20,12 @@ namespace Ltl
 // such as get() and check(). Also consider simplifying zero() so it requires no
 // extra arguments.
 template<typename T, typename... Args>
-static inline void push(lua_State* L, T v, Args&&... args)
+static inline void push(lua_State* L, T&& v, Args&&... args)
 {
     using namespace detail;
-    PushPolicy<typename PushTrait<T>::tag>::template push<T>(L,
-        v, std::forward<Args>(args)...);
+    using value_type = typename std::decay<T>::type;
+    PushPolicy<typename PushTrait<value_type>::tag>::template push<value_type>(L,
+        std::forward<T>(v), std::forward<Args>(args)...);
 }
 
 template<typename T, typename... Args>
@@ -42,6 +44,15 @@ static inline bool type(lua_State* L, int n, Args&&... args)
         std::forward<Args>(args)...);
 }
 
+// type check and cast in a single pass
+template<typename T, typename... Args>
+static inline CastResult<T> try_cast(lua_State* L, int n, Args&&... args)
+{
+    using namespace detail;
+    return TryCastPolicy<typename TryCastTrait<T>::tag>::template try_cast<T>(L, n,
+        std::forward<Args>(args)...);
+}
+
 template<typename T, typename... Args>
 static inline T zero(lua_State* L, int n, Args&&... args)
 {
@@ -51,7 +62,7 @@ static inline T zero(lua_State* L, int n, Args&&... args)
 }
 
 template<typename T, typename... Args>
-static inline std::string name(lua_State* L, int n, Args&&... args)
+static inline const char* name(lua_State* L, int n, Args&&... args)
 {
     using namespace detail;
     return NamePolicy<typename NameTrait<T>::tag>::template name<T>(L, n,
@@ -64,8 +75,9 @@ static inline std::string name(lua_State* L, int n, Args&&... args)
 template<typename T, typename... Args>
 static inline T get_default(lua_State* L, int n, T d, Args&&... args)
 {
-    if ( type<T>(L, n, std::forward<Args>(args)...) )
-        return cast<T>(L, n, std::forward<Args>(args)...);
+    auto r = try_cast<T>(L, n, std::forward<Args>(args)...);
+    if ( r.ok )
+        return std::move(r.value);
     else
         return d;
 }
@@ -73,12 +85,28 @@ static inline T get_default(lua_State* L, int n, T d, Args&&... args)
 template<typename T, typename... Args>
 static inline T get(lua_State* L, int n, Args&&... args)
 {
-    return get_default<T>(L, n, zero<T>(L, n, std::forward<Args>(args)...),
-        std::forward<Args>(args)...);
+    auto r = try_cast<T>(L, n, std::forward<Args>(args)...);
+    if ( r.ok )
+        return std::move(r.value);
+    else
+        return zero<T>(L, n);
 }
 
-// FIXIT-M implement opt() at a higher abstraction layer
-// (requires too much knowledge about stack index validity)
+// push several values with a single stack reservation. returns the number
+// of values pushed
+template<typename... Ts>
+static inline int push_all(lua_State* L, Ts&&... vs)
+{
+    constexpr int count =
+        detail::TotalPushCount<typename std::decay<Ts>::type...>::value;
+
+    luaL_checkstack(L, count + detail::push_scratch, "too many values to push");
+
+    using expand = int[];
+    (void)expand { 0, (push(L, std::forward<Ts>(vs)), 0)... };
+
+    return count;
+}
 }
 
 #endif
@@ -1,14 +1,161 @@
 #ifndef LUA_STACK_CORE_H
 #define LUA_STACK_CORE_H
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
 #include <string>
 #include <type_traits>
+#include <vector>
 #include <luajit-2.0/lua.hpp>
 
 namespace Ltl
 {
 
+// LuaJIT's lua_type() code for ffi cdata (not defined by lua.h)
+static constexpr int lua_tcdata = 10;
+
+// result of a fused type check and cast (see try_cast())
+template<typename T>
+struct CastResult
+{
+    T value;
+    bool ok;
+
+    explicit operator bool() const
+    { return ok; }
+};
+
+// non-owning pointer + length view of a string. a StringView cast from the
+// lua stack is only valid while the value it was cast from is alive
+class StringView
+{
+public:
+    StringView() : ptr { "" }, len { 0 } { }
+
+    StringView(const char* s) :
+        ptr { s }, len { std::strlen(s) } { }
+
+    StringView(const char* s, size_t n) :
+        ptr { s }, len { n } { }
+
+    StringView(const std::string& s) :
+        ptr { s.data() }, len { s.size() } { }
+
+    const char* data() const
+    { return ptr; }
+
+    size_t size() const
+    { return len; }
+
+    bool empty() const
+    { return len == 0; }
+
+    const char* begin() const
+    { return ptr; }
+
+    const char* end() const
+    { return ptr + len; }
+
+    char operator[](size_t i) const
+    { return ptr[i]; }
+
+    std::string str() const
+    { return std::string(ptr, len); }
+
+    friend bool operator==(const StringView& a, const StringView& b)
+    { return a.len == b.len && !std::memcmp(a.ptr, b.ptr, a.len); }
+
+    friend bool operator!=(const StringView& a, const StringView& b)
+    { return !(a == b); }
+
+private:
+    const char* ptr;
+    size_t len;
+};
+
+// a 64-bit integer that is carried without loss: as a lua number when it fits
+// in 53 bits, and as a LuaJIT boxed int64_t or uint64_t cdata otherwise. plain
+// int64_t and uint64_t are numbers, like the other integers:
+//
+//     Ltl::push(L, Ltl::UInt64(flow_id));
+//     uint64_t id = Ltl::cast<Ltl::UInt64>(L, -1);
+template<typename T>
+struct Int64Box
+{
+    using value_type = T;
+
+    Int64Box(T v = 0) : value { v } { }
+
+    operator T() const
+    { return value; }
+
+    T value;
+};
+
+using Int64 = Int64Box<int64_t>;
+using UInt64 = Int64Box<uint64_t>;
+
+// lua names for the enumerators of E. enums are pushed and cast as strings.
+// define() is called at startup, before E is used from more than one thread:
+//
+//     Ltl::Enum<Proto>::define({ { "tcp", Proto::TCP }, { "udp", Proto::UDP } });
+template<typename E>
+class Enum
+{
+public:
+    struct Entry
+    {
+        const char* name;
+        E value;
+    };
+
+    static void define(std::initializer_list<Entry> list)
+    {
+        entries().assign(list.begin(), list.end());
+        ++generation();
+    }
+
+    static const std::vector<Entry>& values()
+    { return entries(); }
+
+    // returns nullptr for values without a name
+    static const char* name(E v)
+    {
+        for ( const auto& e : entries() )
+        {
+            if ( e.value == v )
+                return e.name;
+        }
+
+        return nullptr;
+    }
+
+    // unique registry key for the per-state cache of interned names
+    static void* cache_key()
+    {
+        static char key;
+        return &key;
+    }
+
+    // changed by each define(), so that the per-state caches are rebuilt
+    static size_t& generation()
+    {
+        static size_t g = 0;
+        return g;
+    }
+
+private:
+    static std::vector<Entry>& entries()
+    {
+        static std::vector<Entry> list;
+        return list;
+    }
+};
+
 namespace detail
 {
 // -----------------------------------------------------------------------------
@@ -22,6 +169,8 @@ struct boolean_tag {};
 struct string_tag {};
 struct cstring_tag {};
 struct pointer_tag {};
+struct enum_tag {};
+struct int64_tag {};
 
 // this tag should not be specialized. it is similar in function to the
 // fall-through 'default' switch case
@@ -54,6 +203,36 @@ template<typename T, typename Enable = void>
 struct LuaType
 { static constexpr int code = T::lua_type_code; };
 
+// number of values left on the stack by a push of T
+template<typename T, typename Enable = void>
+struct PushCount
+{ static constexpr int value = 1; };
+
+template<>
+struct PushCount<void>
+{ static constexpr int value = 0; };
+
+// free slots a single push may use beyond the values it leaves on the stack.
+// pushes that need more (containers, for example) reserve it themselves
+static constexpr int push_scratch = 2;
+
+template<typename... Ts>
+struct TotalPushCount
+{ static constexpr int value = 0; };
+
+template<typename T, typename... Ts>
+struct TotalPushCount<T, Ts...>
+{
+    static constexpr int value =
+        PushCount<T>::value + TotalPushCount<Ts...>::value;
+};
+
+// types without a dedicated try_cast implementation fall back to a type
+// check followed by a cast
+template<typename T, typename Enable = void>
+struct TryCastTrait
+{ using tag = default_tag; };
+
 // -----------------------------------------------------------------------------
 // policy definitions
 // -----------------------------------------------------------------------------
@@ -71,6 +250,21 @@ struct TypePolicy
     { return lua_type(L, n) == LuaType<T>::code; }
 };
 
+// fused type check + cast. specializations should validate and convert
+// the value with as few C API calls as possible
+template<typename Tag>
+struct TryCastPolicy
+{
+    template<typename T>
+    static CastResult<T> try_cast(lua_State* L, int n)
+    {
+        if ( !TypePolicy<typename TypeTrait<T>::tag>::template type<T>(L, n) )
+            return { T(), false };
+
+        return { CastPolicy<typename CastTrait<T>::tag>::template cast<T>(L, n), true };
+    }
+};
+
 // default values
 template<typename Tag>
 struct ZeroPolicy
@@ -80,15 +274,289 @@ struct ZeroPolicy
     { return 0; }
 };
 
-// for generating informative error messages
+// for generating informative error messages. names are statically allocated
 template<typename Tag>
 struct NamePolicy
 {
     template<typename T>
-    static std::string name(lua_State* L, int)
+    static const char* name(lua_State* L, int)
     { return lua_typename(L, LuaType<T>::code); }
 };
 
+// -----------------------------------------------------------------------------
+// enum name cache
+// -----------------------------------------------------------------------------
+// lua strings are interned, so the data pointers of E's names identify them.
+// the pointers are cached per state in a userdata stored in the registry,
+// after the Enum generation they were built from. the strings themselves are
+// anchored in the userdata's environment table
+struct EnumCacheHeader
+{
+    size_t generation;
+};
+
+static_assert(sizeof(EnumCacheHeader) % alignof(const char*) == 0,
+    "the names must be aligned after the header");
+
+template<typename E>
+static inline const char* const* cache_enum_names(lua_State* L)
+{
+    const auto& entries = Enum<E>::values();
+
+    luaL_checkstack(L, 4, "cannot cache enum names");
+    lua_pushlightuserdata(L, Enum<E>::cache_key());
+
+    auto header = static_cast<EnumCacheHeader*>(lua_newuserdata(L,
+        sizeof(EnumCacheHeader) + entries.size() * sizeof(const char*)));
+
+    header->generation = Enum<E>::generation();
+    auto names = reinterpret_cast<const char**>(header + 1);
+
+    lua_createtable(L, static_cast<int>(entries.size()), 0);
+
+    for ( size_t i = 0; i < entries.size(); ++i )
+    {
+        lua_pushstring(L, entries[i].name);
+        names[i] = lua_tostring(L, -1);
+        lua_rawseti(L, -2, static_cast<int>(i + 1));
+    }
+
+    lua_setfenv(L, -2);
+    lua_rawset(L, LUA_REGISTRYINDEX);
+
+    return names;
+}
+
+// the cached names, rebuilt if E was defined again since they were cached
+template<typename E>
+static inline const char* const* enum_names(lua_State* L)
+{
+    lua_pushlightuserdata(L, Enum<E>::cache_key());
+    lua_rawget(L, LUA_REGISTRYINDEX);
+    auto header = static_cast<const EnumCacheHeader*>(lua_touserdata(L, -1));
+    lua_pop(L, 1);
+
+    if ( !header || header->generation != Enum<E>::generation() )
+        return cache_enum_names<E>(L);
+
+    return reinterpret_cast<const char* const*>(header + 1);
+}
+
+// -----------------------------------------------------------------------------
+// 64-bit integer support
+// -----------------------------------------------------------------------------
+// Int64 and UInt64 values that do not fit in a lua_Number are carried as
+// LuaJIT boxed int64_t/uint64_t cdata. the ctypes (and a checker for them) are
+// created from the ffi library once per state and cached in the registry.
+//
+// recognizing a box need not call into lua: LuaJIT 2.0 keeps the 16-bit ctype
+// id of a cdata right before its payload. ctype_id() is the only reader of that
+// private layout, and it is only compiled for the LuaJIT versions it was
+// verified against. the ids of the boxes are read when the ctypes are first
+// created, after checking the layout against an int32_t box. the built-in
+// ctype ids are the same in every state. with another version, or if the
+// layout does not match, the ffi checker is called instead
+struct Int64Support
+{
+    // also the kinds returned by check()
+    enum Slot { INT64 = 1, UINT64, CHECK, INT32 };
+
+    // LuaJIT's CTID_INT32, CTID_INT64 and CTID_UINT64
+    enum BuiltinId { ctid_int32 = 9, ctid_int64 = 11, ctid_uint64 = 12 };
+
+#if defined(LUAJIT_VERSION_NUM) && LUAJIT_VERSION_NUM >= 20000 && LUAJIT_VERSION_NUM < 20100
+    static constexpr bool layout_verified = true;
+#else
+    static constexpr bool layout_verified = false;
+#endif
+
+    // 0 before the first check of the layout, -1 if the ffi checker must be
+    // used, otherwise the ids of the int64_t (low) and uint64_t (high) boxes
+    static std::atomic<int>& ids()
+    {
+        static std::atomic<int> v { 0 };
+        return v;
+    }
+
+    static void* key()
+    {
+        static char k;
+        return &k;
+    }
+
+    // push the cached table of ctypes, creating it on first use
+    static void push(lua_State* L)
+    {
+        lua_pushlightuserdata(L, key());
+        lua_rawget(L, LUA_REGISTRYINDEX);
+
+        if ( !lua_isnil(L, -1) )
+            return;
+
+        lua_pop(L, 1);
+        luaL_checkstack(L, 4, "cannot load ffi");
+
+        static const char* chunk =
+            "local ffi = ...\n"
+            "local istype = ffi.istype\n"
+            "local i64, u64 = ffi.typeof('int64_t'), ffi.typeof('uint64_t')\n"
+            "return { i64, u64,\n"
+            "    function(v) return istype(i64, v) and 1 or istype(u64, v) and 2 or 0 end,\n"
+            "    ffi.typeof('int32_t') }";
+
+        luaL_loadstring(L, chunk);
+        push_ffi(L);
+        lua_call(L, 1, 1);
+
+        lua_pushlightuserdata(L, key());
+        lua_pushvalue(L, -2);
+        lua_rawset(L, LUA_REGISTRYINDEX);
+
+        if ( !ids().load(std::memory_order_relaxed) )
+            ids().store(read_ids(L), std::memory_order_relaxed);
+    }
+
+    // reuse the ffi module if a script has already loaded it. luaopen_ffi
+    // registers itself in package.loaded, so it is only opened once
+    static void push_ffi(lua_State* L)
+    {
+        lua_getfield(L, LUA_REGISTRYINDEX, "_LOADED");
+        if ( lua_istable(L, -1) )
+        {
+            lua_getfield(L, -1, LUA_FFILIBNAME);
+            lua_remove(L, -2);
+
+            if ( lua_istable(L, -1) )
+                return;
+        }
+
+        lua_pop(L, 1);
+        lua_pushcfunction(L, luaopen_ffi);
+        lua_call(L, 0, 1);
+    }
+
+    // the payload of the cdata at n (lua_topointer gives its address). boxes
+    // are read and, right after they are created, written through it
+    static void* payload(lua_State* L, int n)
+    { return const_cast<void*>(lua_topointer(L, n)); }
+
+    // the ctype id stored in front of the payload of the cdata at n, or 0 if
+    // the layout is not known for this LuaJIT version
+    static uint16_t ctype_id(lua_State* L, int n)
+    {
+        uint16_t id = 0;
+
+        if ( layout_verified )
+            std::memcpy(&id, static_cast<const char*>(payload(L, n)) - sizeof(id), sizeof(id));
+
+        return id;
+    }
+
+    // create a box of each ctype in the table at the top and check their ids
+    static int read_ids(lua_State* L)
+    {
+        static const int slots[] = { INT32, INT64, UINT64 };
+        static const uint16_t expected[] = { ctid_int32, ctid_int64, ctid_uint64 };
+
+        uint16_t found[3];
+        for ( int i = 0; i < 3; ++i )
+        {
+            lua_rawgeti(L, -1, slots[i]);
+            lua_call(L, 0, 1);
+            found[i] = ctype_id(L, -1);
+            lua_pop(L, 1);
+        }
+
+        for ( int i = 0; i < 3; ++i )
+        {
+            if ( found[i] != expected[i] )
+                return -1;
+        }
+
+        return found[1] | found[2] << 16;
+    }
+
+    // INT64 or UINT64 if the cdata at n is a boxed int64_t or uint64_t, or 0
+    static int check(lua_State* L, int n)
+    {
+        int v = ids().load(std::memory_order_relaxed);
+        if ( !v )
+        {
+            push(L);
+            lua_pop(L, 1);
+            v = ids().load(std::memory_order_relaxed);
+        }
+
+        if ( v > 0 )
+        {
+            int id = ctype_id(L, n);
+            return id == (v & 0xffff) ? INT64 : id == (v >> 16) ? UINT64 : 0;
+        }
+
+        lua_pushvalue(L, n);
+        push(L);
+        lua_rawgeti(L, -1, CHECK);
+        lua_replace(L, -2);
+        lua_insert(L, -2);
+        lua_call(L, 1, 1);
+
+        int kind = static_cast<int>(lua_tointeger(L, -1));
+        lua_pop(L, 1);
+        return kind;
+    }
+};
+
+// lua_Numbers represent integers exactly up to 2^53
+template<typename T>
+static inline bool fits_number(T v)
+{
+    return std::is_signed<T>::value ?
+        v >= -(T(1) << 53) && v <= (T(1) << 53) :
+        v <= (T(1) << 53);
+}
+
+// doubles in the range of T. larger values are not converted
+template<typename T>
+static inline bool number_in_range(lua_Number v)
+{
+    return std::is_signed<T>::value ?
+        v >= -9223372036854775808.0 && v < 9223372036854775808.0 :
+        v >= 0 && v < 18446744073709551616.0;
+}
+
+// the value of a boxed int64_t (kind INT64) or uint64_t (kind UINT64), if it
+// is in the range of T (int64_t or uint64_t)
+template<typename T>
+static inline CastResult<T> int64_from_cdata(lua_State* L, int n, int kind)
+{
+    const void* p = Int64Support::payload(L, n);
+
+    if ( kind == Int64Support::INT64 )
+    {
+        int64_t v;
+        std::memcpy(&v, p, sizeof(v));
+
+        if ( !std::is_signed<T>::value && v < 0 )
+            return { 0, false };
+
+        return { static_cast<T>(v), true };
+    }
+
+    if ( kind == Int64Support::UINT64 )
+    {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+
+        if ( std::is_signed<T>::value &&
+            v > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) )
+            return { 0, false };
+
+        return { static_cast<T>(v), true };
+    }
+
+    return { 0, false };
+}
+
 // -----------------------------------------------------------------------------
 // core policy specializations
 // -----------------------------------------------------------------------------
@@ -109,6 +577,32 @@ struct PushPolicy<integral_tag>
     { lua_pushinteger(L, v); }
 };
 
+// T is an Int64Box
+template<>
+struct PushPolicy<int64_tag>
+{
+    template<typename T>
+    static void push(lua_State* L, T box)
+    {
+        typename T::value_type v = box;
+
+        if ( fits_number(v) )
+        {
+            lua_pushnumber(L, static_cast<lua_Number>(v));
+            return;
+        }
+
+        // construct a zeroed box and write the value into its payload
+        Int64Support::push(L);
+        lua_rawgeti(L, -1, std::is_signed<decltype(v)>::value ?
+            Int64Support::INT64 : Int64Support::UINT64);
+        lua_call(L, 0, 1);
+        lua_remove(L, -2);
+
+        std::memcpy(Int64Support::payload(L, -1), &v, sizeof(v));
+    }
+};
+
 template<>
 struct PushPolicy<pointer_tag>
 {
@@ -130,7 +624,7 @@ struct PushPolicy<string_tag>
 {
     template<typename T>
     static void push(lua_State* L, const T& v)
-    { lua_pushlstring(L, v.c_str(), v.size()); }
+    { lua_pushlstring(L, v.data(), v.size()); }
 };
 
 template<>
@@ -141,6 +635,21 @@ struct PushPolicy<cstring_tag>
     { lua_pushstring(L, v); }
 };
 
+// values without a name are pushed as nil
+template<>
+struct PushPolicy<enum_tag>
+{
+    template<typename T>
+    static void push(lua_State* L, T v)
+    {
+        const char* s = Enum<T>::name(v);
+        if ( s )
+            lua_pushstring(L, s);
+        else
+            lua_pushnil(L);
+    }
+};
+
 //cast
 template<>
 struct CastPolicy<floating_point_tag>
@@ -158,6 +667,24 @@ struct CastPolicy<integral_tag>
     { return lua_tointeger(L, n); }
 };
 
+// only boxed int64_t/uint64_t cdata is read. other cdata, and boxes out of
+// the range of T, cast to 0
+template<>
+struct CastPolicy<int64_tag>
+{
+    template<typename T>
+    static T cast(lua_State* L, int n)
+    {
+        using I = typename T::value_type;
+
+        if ( lua_type(L, n) == lua_tcdata )
+            return int64_from_cdata<I>(L, n, Int64Support::check(L, n)).value;
+
+        lua_Number v = lua_tonumber(L, n);
+        return number_in_range<I>(v) ? static_cast<I>(v) : I(0);
+    }
+};
+
 template<>
 struct CastPolicy<pointer_tag>
 {
@@ -185,7 +712,8 @@ struct CastPolicy<string_tag>
     static T cast(lua_State* L, int n)
     {
         size_t len = 0;
-        return T(lua_tolstring(L, n, &len), len);
+        const char* s = lua_tolstring(L, n, &len);
+        return T(s, len);
     }
 };
 
@@ -212,6 +740,203 @@ struct TypePolicy<unsigned_tag>
     }
 };
 
+template<>
+struct TypePolicy<int64_tag>
+{
+    template<typename T>
+    static bool type(lua_State* L, int n)
+    {
+        switch ( lua_type(L, n) )
+        {
+            case LUA_TNUMBER:
+                return number_in_range<typename T::value_type>(lua_tonumber(L, n));
+
+            case lua_tcdata:
+                return int64_from_cdata<typename T::value_type>(
+                    L, n, Int64Support::check(L, n)).ok;
+
+            default:
+                return false;
+        }
+    }
+};
+
+// try_cast
+template<>
+struct TryCastPolicy<floating_point_tag>
+{
+    template<typename T>
+    static CastResult<T> try_cast(lua_State* L, int n)
+    {
+        if ( lua_type(L, n) != LUA_TNUMBER )
+            return { 0, false };
+
+        return { static_cast<T>(lua_tonumber(L, n)), true };
+    }
+};
+
+template<>
+struct TryCastPolicy<integral_tag>
+{
+    template<typename T>
+    static CastResult<T> try_cast(lua_State* L, int n)
+    {
+        if ( lua_type(L, n) != LUA_TNUMBER )
+            return { 0, false };
+
+        return { static_cast<T>(lua_tointeger(L, n)), true };
+    }
+};
+
+template<>
+struct TryCastPolicy<unsigned_tag>
+{
+    template<typename T>
+    static CastResult<T> try_cast(lua_State* L, int n)
+    {
+        if ( lua_type(L, n) != LUA_TNUMBER )
+            return { 0, false };
+
+        auto v = lua_tointeger(L, n);
+        if ( v < 0 )
+            return { 0, false };
+
+        return { static_cast<T>(v), true };
+    }
+};
+
+template<>
+struct TryCastPolicy<int64_tag>
+{
+    template<typename T>
+    static CastResult<T> try_cast(lua_State* L, int n)
+    {
+        using I = typename T::value_type;
+
+        int t = lua_type(L, n);
+        if ( t == LUA_TNUMBER )
+        {
+            lua_Number v = lua_tonumber(L, n);
+            if ( !number_in_range<I>(v) )
+                return { 0, false };
+
+            return { static_cast<I>(v), true };
+        }
+
+        if ( t != lua_tcdata )
+            return { 0, false };
+
+        auto r = int64_from_cdata<I>(L, n, Int64Support::check(L, n));
+        return { r.value, r.ok };
+    }
+};
+
+template<>
+struct TryCastPolicy<pointer_tag>
+{
+    template<typename T>
+    static CastResult<T> try_cast(lua_State* L, int n)
+    {
+        if ( lua_type(L, n) != LUA_TLIGHTUSERDATA )
+            return { nullptr, false };
+
+        return { static_cast<T>(const_cast<void*>(lua_topointer(L, n))), true };
+    }
+};
+
+template<>
+struct TryCastPolicy<boolean_tag>
+{
+    template<typename T>
+    static CastResult<T> try_cast(lua_State* L, int n)
+    {
+        if ( lua_type(L, n) != LUA_TBOOLEAN )
+            return { false, false };
+
+        return { static_cast<T>(lua_toboolean(L, n)), true };
+    }
+};
+
+template<>
+struct TryCastPolicy<string_tag>
+{
+    template<typename T>
+    static CastResult<T> try_cast(lua_State* L, int n)
+    {
+        if ( lua_type(L, n) != LUA_TSTRING )
+            return { T(), false };
+
+        size_t len = 0;
+        const char* s = lua_tolstring(L, n, &len);
+        return { T(s, len), true };
+    }
+};
+
+template<>
+struct TryCastPolicy<cstring_tag>
+{
+    template<typename T>
+    static CastResult<T> try_cast(lua_State* L, int n)
+    {
+        if ( lua_type(L, n) != LUA_TSTRING )
+            return { nullptr, false };
+
+        return { lua_tostring(L, n), true };
+    }
+};
+
+// matched by pointer identity against the interned names. the text compare
+// only runs for strings that are not one of E's names, and keeps this correct
+// should a string ever not be interned
+template<>
+struct TryCastPolicy<enum_tag>
+{
+    template<typename T>
+    static CastResult<T> try_cast(lua_State* L, int n)
+    {
+        if ( lua_type(L, n) != LUA_TSTRING )
+            return { T(), false };
+
+        size_t len = 0;
+        const char* s = lua_tolstring(L, n, &len);
+
+        const auto& entries = Enum<T>::values();
+        auto names = enum_names<T>(L);
+
+        for ( size_t i = 0; i < entries.size(); ++i )
+        {
+            if ( names[i] == s )
+                return { entries[i].value, true };
+        }
+
+        for ( const auto& e : entries )
+        {
+            if ( std::strlen(e.name) == len && !std::memcmp(e.name, s, len) )
+                return { e.value, true };
+        }
+
+        return { T(), false };
+    }
+};
+
+// cast
+template<>
+struct CastPolicy<enum_tag>
+{
+    template<typename T>
+    static T cast(lua_State* L, int n)
+    { return TryCastPolicy<enum_tag>::try_cast<T>(L, n).value; }
+};
+
+// type
+template<>
+struct TypePolicy<enum_tag>
+{
+    template<typename T>
+    static bool type(lua_State* L, int n)
+    { return TryCastPolicy<enum_tag>::try_cast<T>(L, n).ok; }
+};
+
 // zero
 template<>
 struct ZeroPolicy<string_tag>
@@ -221,12 +946,20 @@ struct ZeroPolicy<string_tag>
     { return ""; }
 };
 
+template<>
+struct ZeroPolicy<enum_tag>
+{
+    template<typename T>
+    static T zero(lua_State*, int)
+    { return T(); }
+};
+
 // name
 template<>
 struct NamePolicy<integral_tag>
 {
     template<typename T>
-    static std::string name(lua_State*, int)
+    static const char* name(lua_State*, int)
     { return "integer"; }
 };
 
@@ -234,15 +967,23 @@ template<>
 struct NamePolicy<unsigned_tag>
 {
     template<typename T>
-    static std::string name(lua_State*, int)
+    static const char* name(lua_State*, int)
     { return "unsigned"; }
 };
 
+template<>
+struct NamePolicy<int64_tag>
+{
+    template<typename T>
+    static const char* name(lua_State*, int)
+    { return std::is_signed<typename T::value_type>::value ? "int64" : "uint64"; }
+};
+
 template<>
 struct NamePolicy<pointer_tag>
 {
     template<typename T>
-    static std::string name(lua_State*, int)
+    static const char* name(lua_State*, int)
     { return "pointer"; }
 };
 
@@ -250,6 +991,12 @@ struct NamePolicy<pointer_tag>
 // core trait specializations
 // -----------------------------------------------------------------------------
 
+template<typename T>
+struct is_int64_box : std::false_type {};
+
+template<typename T>
+struct is_int64_box<Int64Box<T>> : std::true_type {};
+
 // type traits helpers
 template<typename T>
 struct CTraits
@@ -262,32 +1009,39 @@ struct CTraits
 
     static constexpr bool is_integral = std::is_integral<T>::value && !is_bool;
 
+    // Int64 and UInt64, which are not limited to lua_Number (see int64_tag)
+    static constexpr bool is_int64 = is_int64_box<T>::value;
+
     static constexpr bool is_signed_int =
         is_integral && std::is_signed<T>::value && size <= integral_max_size;
 
     static constexpr bool is_unsigned_int =
-        is_integral && std::is_unsigned<T>::value && size < integral_max_size;
+        is_integral && std::is_unsigned<T>::value && size <= integral_max_size;
 
     static constexpr bool is_int = is_signed_int || is_unsigned_int;
 
     static constexpr bool is_float =
         std::is_floating_point<T>::value && size <= float_max_size;
 
-    static constexpr bool is_numeric = is_int || is_float;
+    static constexpr bool is_numeric = is_int || is_int64 || is_float;
 
     static constexpr bool is_string =
         std::is_same<T, const char*>::value ||
-        std::is_same<T, std::string>::value;
+        std::is_same<T, std::string>::value ||
+        std::is_same<T, StringView>::value;
 
     static constexpr bool is_pointer =
         std::is_pointer<T>::value &&
         !is_string; // handle const char* case
 
+    static constexpr bool is_enum = std::is_enum<T>::value;
+
     static constexpr bool is_basic =
         is_numeric ||
         is_bool ||
         is_string ||
-        is_pointer;
+        is_pointer ||
+        is_enum;
 };
 
 // push trait
@@ -311,10 +1065,22 @@ template<>
 struct PushTrait<std::string>
 { using tag = string_tag; };
 
+template<>
+struct PushTrait<StringView>
+{ using tag = string_tag; };
+
 template<>
 struct PushTrait<const char*>
 { using tag = cstring_tag; };
 
+template<typename T>
+struct PushTrait<T, typename std::enable_if<CTraits<T>::is_enum>::type>
+{ using tag = enum_tag; };
+
+template<typename T>
+struct PushTrait<T, typename std::enable_if<CTraits<T>::is_int64>::type>
+{ using tag = int64_tag; };
+
 // cast trait
 template<typename T>
 struct CastTrait<T, typename std::enable_if<CTraits<T>::is_float>::type>
@@ -336,15 +1102,29 @@ template<>
 struct CastTrait<std::string>
 { using tag = string_tag; };
 
+template<>
+struct CastTrait<StringView>
+{ using tag = string_tag; };
+
 template<>
 struct CastTrait<const char*>
 { using tag = cstring_tag; };
 
+template<typename T>
+struct CastTrait<T, typename std::enable_if<CTraits<T>::is_enum>::type>
+{ using tag = enum_tag; };
+
+template<typename T>
+struct CastTrait<T, typename std::enable_if<CTraits<T>::is_int64>::type>
+{ using tag = int64_tag; };
+
 // type trait
 template<typename T>
 struct TypeTrait<T, typename std::enable_if<
     CTraits<T>::is_basic &&
-    !CTraits<T>::is_unsigned_int
+    !CTraits<T>::is_unsigned_int &&
+    !CTraits<T>::is_int64 &&
+    !CTraits<T>::is_enum
     >::type>
 { using tag = default_tag; };
 
@@ -352,11 +1132,61 @@ template<typename T>
 struct TypeTrait<T, typename std::enable_if<CTraits<T>::is_unsigned_int>::type>
 { using tag = unsigned_tag; };
 
+template<typename T>
+struct TypeTrait<T, typename std::enable_if<CTraits<T>::is_enum>::type>
+{ using tag = enum_tag; };
+
+template<typename T>
+struct TypeTrait<T, typename std::enable_if<CTraits<T>::is_int64>::type>
+{ using tag = int64_tag; };
+
+// try_cast trait
+template<typename T>
+struct TryCastTrait<T, typename std::enable_if<CTraits<T>::is_float>::type>
+{ using tag = floating_point_tag; };
+
+template<typename T>
+struct TryCastTrait<T, typename std::enable_if<CTraits<T>::is_signed_int>::type>
+{ using tag = integral_tag; };
+
+template<typename T>
+struct TryCastTrait<T, typename std::enable_if<CTraits<T>::is_unsigned_int>::type>
+{ using tag = unsigned_tag; };
+
+template<typename T>
+struct TryCastTrait<T, typename std::enable_if<CTraits<T>::is_pointer>::type>
+{ using tag = pointer_tag; };
+
+template<>
+struct TryCastTrait<bool>
+{ using tag = boolean_tag; };
+
+template<>
+struct TryCastTrait<std::string>
+{ using tag = string_tag; };
+
+template<>
+struct TryCastTrait<StringView>
+{ using tag = string_tag; };
+
+template<>
+struct TryCastTrait<const char*>
+{ using tag = cstring_tag; };
+
+template<typename T>
+struct TryCastTrait<T, typename std::enable_if<CTraits<T>::is_enum>::type>
+{ using tag = enum_tag; };
+
+template<typename T>
+struct TryCastTrait<T, typename std::enable_if<CTraits<T>::is_int64>::type>
+{ using tag = int64_tag; };
+
 // zero trait
 template<typename T>
 struct ZeroTrait<T, typename std::enable_if<
     CTraits<T>::is_basic &&
-    !CTraits<T>::is_string
+    !CTraits<T>::is_string &&
+    !CTraits<T>::is_enum
     >::type>
 { using tag = default_tag; };
 
@@ -364,15 +1194,24 @@ template<typename T>
 struct ZeroTrait<T, typename std::enable_if<CTraits<T>::is_string>::type>
 { using tag = string_tag; };
 
+template<typename T>
+struct ZeroTrait<T, typename std::enable_if<CTraits<T>::is_enum>::type>
+{ using tag = enum_tag; };
+
 // name trait
 template<typename T>
 struct NameTrait<T, typename std::enable_if<
     CTraits<T>::is_basic &&
     !CTraits<T>::is_int &&
+    !CTraits<T>::is_int64 &&
     !CTraits<T>::is_pointer
     >::type>
 { using tag = default_tag; };
 
+template<typename T>
+struct NameTrait<T, typename std::enable_if<CTraits<T>::is_int64>::type>
+{ using tag = int64_tag; };
+
 template<typename T>
 struct NameTrait<T, typename std::enable_if<CTraits<T>::is_signed_int>::type>
 { using tag = integral_tag; };
@@ -401,10 +1240,18 @@ template<>
 struct LuaType<std::string>
 { static constexpr int code = LUA_TSTRING; };
 
+template<>
+struct LuaType<StringView>
+{ static constexpr int code = LUA_TSTRING; };
+
 template<>
 struct LuaType<const char*>
 { static constexpr int code = LUA_TSTRING; };
 
+template<typename T>
+struct LuaType<T, typename std::enable_if<CTraits<T>::is_enum>::type>
+{ static constexpr int code = LUA_TSTRING; };
+
 } // namespace detail
 
 }
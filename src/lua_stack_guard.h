@@ -0,0 +1,112 @@
+#ifndef LUA_STACK_GUARD_H
+#define LUA_STACK_GUARD_H
+
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <luajit-2.0/lua.hpp>
+
+namespace Ltl
+{
+
+// checks that a scope changes the stack top by an expected amount:
+//
+//     StackGuard guard(L, "open", 2);  // leaves two tables on the stack
+//
+// the check runs when the guard goes out of scope, and is skipped while a C++
+// exception unwinds. a mismatch is reported to the handler, which prints the
+// name and the delta and aborts by default. tests can install their own with
+// set_handler().
+//
+// with NDEBUG defined a guard is empty and does nothing
+class StackGuard
+{
+public:
+    using handler_t = void (*)(const char* name, int expected, int actual);
+
+    // the delta is set by results() when the guarded proxy returns. such a
+    // guard does not check on its own, so a lua error raised through it is
+    // not reported as an imbalance
+    static constexpr int result_count = INT_MIN;
+
+#ifdef NDEBUG
+    StackGuard(lua_State*, const char* = nullptr, int = 0) { }
+
+    int results(int n)
+    { return n; }
+#else
+    // a null name reports the name the running function was called by
+    StackGuard(lua_State* L, const char* name = nullptr, int delta = 0) :
+        L { L }, name { name }, top { lua_gettop(L) }, delta { delta } { }
+
+    StackGuard(const StackGuard&) = delete;
+    StackGuard& operator=(const StackGuard&) = delete;
+
+    ~StackGuard()
+    {
+        if ( delta != result_count && !std::uncaught_exception() )
+            check();
+    }
+
+    // check that exactly the n results were pushed, and return n
+    int results(int n)
+    {
+        delta = n;
+        check();
+        delta = result_count;
+        return n;
+    }
+#endif
+
+    // install h as the handler for mismatches. a null handler restores the
+    // default. returns the previous handler
+    static handler_t set_handler(handler_t h)
+    {
+        handler_t prev = handler();
+        handler() = h ? h : &abort_handler;
+        return prev;
+    }
+
+private:
+    static handler_t& handler()
+    {
+        static handler_t h = &abort_handler;
+        return h;
+    }
+
+    static void abort_handler(const char* name, int expected, int actual)
+    {
+        std::fprintf(stderr, "Ltl::StackGuard: %s changed the stack by %d, expected %d\n",
+            name, actual, expected);
+
+        std::abort();
+    }
+
+#ifndef NDEBUG
+    void check() const
+    {
+        int actual = lua_gettop(L) - top;
+        if ( actual != delta )
+            handler()(name ? name : function_name(L), delta, actual);
+    }
+
+    static const char* function_name(lua_State* L)
+    {
+        lua_Debug ar;
+        if ( lua_getstack(L, 0, &ar) && lua_getinfo(L, "n", &ar) && ar.name )
+            return ar.name;
+
+        return "(unknown function)";
+    }
+
+    lua_State* L;
+    const char* name;
+    int top;
+    int delta;
+#endif
+};
+
+}
+
+#endif
@@ -1,16 +1,102 @@
 #ifndef STACK_VIEW_H
 #define STACK_VIEW_H
 
-#include<luajit-2.0/lua.hpp>
+#include <cstddef>
+#include <iterator>
+#include <luajit-2.0/lua.hpp>
 
 #include "lua_ref.h"
+#include "lua_sandbox.h"
+#include "lua_util.h"
 
 namespace Ltl
 {
 
+namespace detail
+{
+
+struct stack_view_tag {};
+
+// a view cast from index n covers n to the top of the stack
+template<>
+struct CastPolicy<stack_view_tag>
+{
+    template<typename T>
+    static T cast(lua_State* L, int n)
+    {
+        int top = lua_gettop(L);
+        return T(L, util::abs_index(n, top), top);
+    }
+};
+
+template<>
+struct ZeroPolicy<stack_view_tag>
+{
+    template<typename T>
+    static T zero(lua_State*, int)
+    { return T(); }
+};
+
+template<>
+struct NamePolicy<stack_view_tag>
+{
+    template<typename T>
+    static const char* name(lua_State*, int)
+    { return "StackView"; }
+};
+
+} // namespace detail
+
+// a frame of consecutive stack slots [bottom, top]. the bounds are fixed when
+// the view is created, and values are addressed from 1 relative to bottom.
+// slots beyond the view read as none.
+//
+// a bound function may take a StackView as its last parameter to receive the
+// remaining arguments. Func::pcall<StackView>() leaves the results on the
+// stack and returns a view of them
 class StackView
 {
 public:
+    using cast_tag = detail::stack_view_tag;
+    using type_tag = detail::generic_tag;
+    using zero_tag = detail::stack_view_tag;
+    using name_tag = detail::stack_view_tag;
+
+    class iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Ref;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Ref;
+
+        iterator(lua_State* L, int n) : L { L }, n { n } { }
+
+        Ref operator*() const
+        { return { L, n }; }
+
+        iterator& operator++()
+        { ++n; return *this; }
+
+        iterator operator++(int)
+        { return iterator(L, n++); }
+
+        bool operator==(const iterator& other) const
+        { return n == other.n; }
+
+        bool operator!=(const iterator& other) const
+        { return n != other.n; }
+
+    private:
+        lua_State* L;
+        int n;
+    };
+
+    // an empty view
+    StackView() :
+        L { nullptr }, bottom { 1 }, top { 0 } { }
+
     StackView(lua_State* L) :
         StackView(L, lua_gettop(L)) { }
 
@@ -23,8 +109,40 @@ public:
     int size() const
     { return top - bottom + 1; }
 
-    Ref operator[](int n)
-    { return {L, n}; }
+    bool empty() const
+    { return size() <= 0; }
+
+    lua_State* state() const
+    { return L; }
+
+    // the absolute stack index of value i
+    int index(int i) const
+    {
+        if ( i >= 1 && i <= size() )
+            return bottom + i - 1;
+
+        // any slot above the stack top reads as none
+        return lua_gettop(L) + 1;
+    }
+
+    Ref operator[](int i) const
+    { return { L, index(i) }; }
+
+    // value i, or zero<T>() if it cannot be converted
+    template<typename T>
+    T get(int i) const
+    { return Ltl::get<T>(L, index(i)); }
+
+    // value i. throws a TypeError if it cannot be converted
+    template<typename T>
+    detail::userdata_wrapped_t<T> check(int i) const
+    { return Ltl::check<T>(L, index(i)); }
+
+    iterator begin() const
+    { return iterator(L, bottom); }
+
+    iterator end() const
+    { return iterator(L, empty() ? bottom : top + 1); }
 
 protected:
     lua_State* L;
@@ -34,6 +152,39 @@ public:
     const int top;
 };
 
+// a StackView that pops its frame (and anything pushed above it) when it goes
+// out of scope:
+//
+//     Ltl::ScopedStackView results(func.pcall<Ltl::StackView>().value);
+class ScopedStackView : public StackView
+{
+public:
+    ScopedStackView(const StackView& v) : StackView(v) { }
+
+    ScopedStackView(const ScopedStackView&) = delete;
+    ScopedStackView& operator=(const ScopedStackView&) = delete;
+
+    ~ScopedStackView()
+    {
+        if ( L )
+            lua_settop(L, bottom - 1);
+    }
+};
+
+namespace detail
+{
+
+// a StackView parameter receives the rest of the arguments as they are
+template<>
+struct CheckTrait<StackView>
+{ using tag = default_tag; };
+
+template<>
+struct add_userdata_wrapper<StackView>
+{ using type = StackView; };
+
+} // namespace detail
+
 }
 
 #endif
@@ -0,0 +1,290 @@
+#ifndef LUA_STRUCT_H
+#define LUA_STRUCT_H
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <luajit-2.0/lua.hpp>
+
+#include "lua_stack_api.h"
+#include "lua_sandbox.h"
+#include "lua_util.h"
+
+namespace Ltl
+{
+
+// a named data member of Class
+template<typename Class, typename T>
+struct Field
+{
+    const char* name;
+    T Class::* member;
+};
+
+// the field list of an aggregate. StructDef specializations derive from this:
+//
+//     template<>
+//     struct Ltl::StructDef<Flow> : Ltl::Fields<Flow, uint32_t, uint16_t>
+//     {
+//         StructDef() : Fields({ "addr", &Flow::addr }, { "port", &Flow::port }) { }
+//     };
+template<typename Class, typename... Ts>
+class Fields
+{
+public:
+    static constexpr bool defined = true;
+    static constexpr size_t size = sizeof...(Ts);
+
+    Fields(Field<Class, Ts>... fs) : fields { fs... } { }
+
+    const std::tuple<Field<Class, Ts>...>& list() const
+    { return fields; }
+
+private:
+    std::tuple<Field<Class, Ts>...> fields;
+};
+
+// specialize to convert T to and from lua tables
+template<typename T>
+struct StructDef
+{ static constexpr bool defined = false; };
+
+namespace detail
+{
+
+struct struct_tag {};
+
+template<typename T>
+struct is_struct
+{ static constexpr bool value = StructDef<T>::defined; };
+
+template<typename T>
+struct StructInfo
+{
+    static const StructDef<T>& def()
+    {
+        static const StructDef<T> d;
+        return d;
+    }
+
+    static void* key()
+    {
+        static char k;
+        return &k;
+    }
+
+    // push the array of field names. the names are interned once per state
+    // and anchored in the registry, so the field keys are never hashed again
+    static void push_keys(lua_State* L)
+    {
+        lua_pushlightuserdata(L, key());
+        lua_rawget(L, LUA_REGISTRYINDEX);
+
+        if ( !lua_isnil(L, -1) )
+            return;
+
+        lua_pop(L, 1);
+        luaL_checkstack(L, 4, "cannot cache struct keys");
+        lua_createtable(L, static_cast<int>(StructDef<T>::size), 0);
+        KeyLoop<0, StructDef<T>::size>::push(L, def().list());
+
+        lua_pushlightuserdata(L, key());
+        lua_pushvalue(L, -2);
+        lua_rawset(L, LUA_REGISTRYINDEX);
+    }
+
+private:
+    template<size_t I, size_t N>
+    struct KeyLoop
+    {
+        template<typename Fs>
+        static void push(lua_State* L, const Fs& fs)
+        {
+            lua_pushstring(L, std::get<I>(fs).name);
+            lua_rawseti(L, -2, static_cast<int>(I + 1));
+            KeyLoop<I + 1, N>::push(L, fs);
+        }
+    };
+
+    template<size_t N>
+    struct KeyLoop<N, N>
+    {
+        template<typename Fs>
+        static void push(lua_State*, const Fs&) { }
+    };
+};
+
+// per-field push and read. keys and table are absolute stack indices
+template<size_t I, size_t N>
+struct FieldLoop
+{
+    template<typename T, typename Fs>
+    static void push(lua_State* L, const T& v, const Fs& fs, int keys, int table)
+    {
+        lua_rawgeti(L, keys, static_cast<int>(I + 1));
+        Ltl::push(L, v.*(std::get<I>(fs).member));
+        lua_rawset(L, table);
+
+        FieldLoop<I + 1, N>::push(L, v, fs, keys, table);
+    }
+
+    // if strict is set, stop at the first field that cannot be converted.
+    // otherwise, such fields are left as they are
+    template<typename T, typename Fs>
+    static bool read(lua_State* L, T& out, const Fs& fs, int keys, int table, bool strict)
+    {
+        auto member = std::get<I>(fs).member;
+        using field_type = typename std::decay<decltype(out.*member)>::type;
+
+        lua_rawgeti(L, keys, static_cast<int>(I + 1));
+        lua_rawget(L, table);
+        auto r = Ltl::try_cast<field_type>(L, -1);
+        lua_pop(L, 1);
+
+        if ( r.ok )
+            out.*member = std::move(r.value);
+        else if ( strict )
+            return false;
+
+        return FieldLoop<I + 1, N>::read(L, out, fs, keys, table, strict);
+    }
+};
+
+template<size_t N>
+struct FieldLoop<N, N>
+{
+    template<typename T, typename Fs>
+    static void push(lua_State*, const T&, const Fs&, int, int) { }
+
+    template<typename T, typename Fs>
+    static bool read(lua_State*, T&, const Fs&, int, int, bool)
+    { return true; }
+};
+
+template<typename T>
+static inline bool read_struct(lua_State* L, int n, T& out, bool strict)
+{
+    n = util::abs_index(L, n);
+
+    luaL_checkstack(L, 2 + push_scratch, "cannot read struct");
+    StructInfo<T>::push_keys(L);
+    int keys = lua_gettop(L);
+
+    bool ok = FieldLoop<0, StructDef<T>::size>::read(
+        L, out, StructInfo<T>::def().list(), keys, n, strict);
+
+    lua_pop(L, 1);
+    return ok;
+}
+
+// -----------------------------------------------------------------------------
+// policies
+// -----------------------------------------------------------------------------
+template<>
+struct PushPolicy<struct_tag>
+{
+    template<typename T>
+    static void push(lua_State* L, const T& v)
+    {
+        lua_createtable(L, 0, static_cast<int>(StructDef<T>::size));
+        int table = lua_gettop(L);
+
+        // keys, key and value
+        luaL_checkstack(L, 3 + push_scratch, "cannot push struct");
+
+        StructInfo<T>::push_keys(L);
+        int keys = lua_gettop(L);
+
+        FieldLoop<0, StructDef<T>::size>::push(
+            L, v, StructInfo<T>::def().list(), keys, table);
+
+        lua_pop(L, 1);
+    }
+};
+
+// cast does no type checking. fields which cannot be converted are
+// value-initialized
+template<>
+struct CastPolicy<struct_tag>
+{
+    template<typename T>
+    static T cast(lua_State* L, int n)
+    {
+        T out {};
+        if ( lua_istable(L, n) )
+            read_struct(L, n, out, false);
+
+        return out;
+    }
+};
+
+// try_cast fails if any field is missing or cannot be converted
+template<>
+struct TryCastPolicy<struct_tag>
+{
+    template<typename T>
+    static CastResult<T> try_cast(lua_State* L, int n)
+    {
+        T out {};
+        if ( !lua_istable(L, n) || !read_struct(L, n, out, true) )
+            return { T {}, false };
+
+        return { std::move(out), true };
+    }
+};
+
+template<>
+struct ZeroPolicy<struct_tag>
+{
+    template<typename T>
+    static T zero(lua_State*, int)
+    { return T {}; }
+};
+
+// -----------------------------------------------------------------------------
+// trait specializations
+// -----------------------------------------------------------------------------
+template<typename T>
+struct PushTrait<T, typename std::enable_if<is_struct<T>::value>::type>
+{ using tag = struct_tag; };
+
+template<typename T>
+struct CastTrait<T, typename std::enable_if<is_struct<T>::value>::type>
+{ using tag = struct_tag; };
+
+template<typename T>
+struct TryCastTrait<T, typename std::enable_if<is_struct<T>::value>::type>
+{ using tag = struct_tag; };
+
+// type() only checks for a table. use try_cast() to validate the fields
+template<typename T>
+struct TypeTrait<T, typename std::enable_if<is_struct<T>::value>::type>
+{ using tag = default_tag; };
+
+template<typename T>
+struct ZeroTrait<T, typename std::enable_if<is_struct<T>::value>::type>
+{ using tag = struct_tag; };
+
+template<typename T>
+struct NameTrait<T, typename std::enable_if<is_struct<T>::value>::type>
+{ using tag = default_tag; };
+
+template<typename T>
+struct LuaType<T, typename std::enable_if<is_struct<T>::value>::type>
+{ static constexpr int code = LUA_TTABLE; };
+
+// structs are checked by value rather than as userdata
+template<typename T>
+struct CheckTrait<T, typename std::enable_if<is_struct<T>::value>::type>
+{ using tag = default_tag; };
+
+template<typename T>
+struct add_userdata_wrapper<T, typename std::enable_if<is_struct<T>::value>::type>
+{ using type = T; };
+
+} // namespace detail
+
+}
+
+#endif
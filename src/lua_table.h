@@ -0,0 +1,288 @@
+#ifndef LUA_TABLE_H
+#define LUA_TABLE_H
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <luajit-2.0/lua.hpp>
+
+#include "lua_stack_api.h"
+#include "lua_ref.h"
+#include "lua_util.h"
+
+namespace Ltl
+{
+
+namespace detail
+{
+
+// how a key is looked up in a table. keys are pushed through the push
+// policies and looked up with a raw get or set
+template<typename K, typename Enable = void>
+struct TableKey
+{
+    static void get(lua_State* L, int t, const K& k)
+    {
+        Ltl::push(L, k);
+        lua_rawget(L, t);
+    }
+
+    template<typename V>
+    static void set(lua_State* L, int t, const K& k, V&& v)
+    {
+        Ltl::push(L, k);
+        Ltl::push(L, std::forward<V>(v));
+        lua_rawset(L, t);
+    }
+};
+
+// integer keys that fit in an int go straight to the array part. larger ones
+// are looked up as numbers
+template<typename K>
+struct TableKey<K, typename std::enable_if<CTraits<K>::is_integral>::type>
+{
+    static void get(lua_State* L, int t, K k)
+    {
+        if ( fits(k) )
+            lua_rawgeti(L, t, static_cast<int>(k));
+        else
+        {
+            lua_pushnumber(L, static_cast<lua_Number>(k));
+            lua_rawget(L, t);
+        }
+    }
+
+    template<typename V>
+    static void set(lua_State* L, int t, K k, V&& v)
+    {
+        if ( fits(k) )
+        {
+            Ltl::push(L, std::forward<V>(v));
+            lua_rawseti(L, t, static_cast<int>(k));
+        }
+        else
+        {
+            lua_pushnumber(L, static_cast<lua_Number>(k));
+            Ltl::push(L, std::forward<V>(v));
+            lua_rawset(L, t);
+        }
+    }
+
+    // lua_rawgeti takes an int
+    static bool fits(K k)
+    {
+        return std::is_signed<K>::value ?
+            static_cast<intmax_t>(k) >= INT_MIN && static_cast<intmax_t>(k) <= INT_MAX :
+            static_cast<uintmax_t>(k) <= static_cast<uintmax_t>(INT_MAX);
+    }
+};
+
+} // namespace detail
+
+// a table entry during iteration. Ref keys and values refer to the stack slots
+// used by lua_next, so they are only valid until the iterator is advanced.
+// other types are converted with try_cast
+template<typename K = Ref, typename V = Ref>
+struct TableEntry
+{
+    K key;
+    V value;
+};
+
+// iterates over the entries of a table with lua_next. entries whose key or
+// value does not convert to K or V are skipped, so a
+// TableIterator<std::string, int> visits the string keys with number values.
+// the key and value are kept on the stack while an entry is visited. the stack
+// top is restored when the iterator is destroyed, so stopping early leaves
+// the stack as it was. iterators are move-only, as each copy would restore it
+template<typename K = Ref, typename V = Ref>
+class TableIterator
+{
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = TableEntry<K, V>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    // end iterator
+    TableIterator() : L { nullptr }, table { 0 }, top { 0 }, entry { } { }
+
+    TableIterator(lua_State* L, int table) :
+        L { L }, table { table }, top { lua_gettop(L) }, entry { }
+    {
+        lua_pushnil(L);
+        next();
+    }
+
+    TableIterator(const TableIterator&) = delete;
+    TableIterator& operator=(const TableIterator&) = delete;
+
+    TableIterator(TableIterator&& other) :
+        L { other.L }, table { other.table }, top { other.top },
+        entry(std::move(other.entry))
+    { other.L = nullptr; }
+
+    ~TableIterator()
+    {
+        if ( L )
+            lua_settop(L, top);
+    }
+
+    reference operator*() const
+    { return entry; }
+
+    pointer operator->() const
+    { return &entry; }
+
+    TableIterator& operator++()
+    {
+        lua_pop(L, 1);
+        next();
+        return *this;
+    }
+
+    bool operator==(const TableIterator& other) const
+    { return L == other.L; }
+
+    bool operator!=(const TableIterator& other) const
+    { return L != other.L; }
+
+private:
+    void next()
+    {
+        while ( lua_next(L, table) )
+        {
+            auto k = try_cast<K>(L, -2);
+            auto v = try_cast<V>(L, -1);
+
+            if ( k.ok && v.ok )
+            {
+                entry = { std::move(k.value), std::move(v.value) };
+                return;
+            }
+
+            lua_pop(L, 1);
+        }
+
+        // lua_next popped the last key
+        L = nullptr;
+    }
+
+    lua_State* L;
+    int table;
+    int top;
+    value_type entry;
+};
+
+// the entries of a table as K, V pairs (see Table::entries())
+template<typename K, typename V>
+class TableRange
+{
+public:
+    TableRange(lua_State* L, int table) : L { L }, table { table } { }
+
+    TableIterator<K, V> begin() const
+    { return TableIterator<K, V>(L, table); }
+
+    TableIterator<K, V> end() const
+    { return TableIterator<K, V>(); }
+
+private:
+    lua_State* L;
+    int table;
+};
+
+// -----------------------------------------------------------------------------
+// field and global access
+// -----------------------------------------------------------------------------
+
+// these invoke metamethods, like lua_getfield and lua_setfield. the key may be
+// any pushable value, including an interned Ltl::Key. idx may be a pseudo-index
+template<typename T, typename K>
+static inline T get_field(lua_State* L, int idx, const K& key)
+{
+    if ( idx > LUA_REGISTRYINDEX )
+        idx = util::abs_index(L, idx);
+
+    push(L, key);
+    lua_gettable(L, idx);
+
+    T v = get<T>(L, -1);
+    lua_pop(L, 1);
+    return v;
+}
+
+template<typename K, typename V>
+static inline void set_field(lua_State* L, int idx, const K& key, V&& v)
+{
+    if ( idx > LUA_REGISTRYINDEX )
+        idx = util::abs_index(L, idx);
+
+    push(L, key);
+    push(L, std::forward<V>(v));
+    lua_settable(L, idx);
+}
+
+template<typename T, typename K>
+static inline T get_global(lua_State* L, const K& key)
+{ return get_field<T>(L, LUA_GLOBALSINDEX, key); }
+
+template<typename K, typename V>
+static inline void set_global(lua_State* L, const K& key, V&& v)
+{ set_field(L, LUA_GLOBALSINDEX, key, std::forward<V>(v)); }
+
+// -----------------------------------------------------------------------------
+// table handle
+// -----------------------------------------------------------------------------
+
+// all accessors are raw: metamethods are not invoked
+class Table : public detail::Ref<Table>
+{
+public:
+    static constexpr int lua_type_code = LUA_TTABLE;
+
+    using iterator = TableIterator<>;
+
+    Table() : detail::Ref<Table>() { }
+    Table(lua_State* L, int n) : detail::Ref<Table> { L, n } { }
+
+    // the value at key, or zero<T>() if it cannot be converted to T
+    template<typename T, typename K>
+    T get(const K& key) const
+    {
+        detail::TableKey<K>::get(L, util::abs_index(L, index()), key);
+        T v = Ltl::get<T>(L, -1);
+        lua_pop(L, 1);
+        return v;
+    }
+
+    template<typename K, typename V>
+    void set(const K& key, V&& v) const
+    { detail::TableKey<K>::set(L, util::abs_index(L, index()), key, std::forward<V>(v)); }
+
+    // length of the array part (the border found by the # operator)
+    size_t size() const
+    { return lua_objlen(L, index()); }
+
+    iterator begin() const
+    { return iterator(L, util::abs_index(L, index())); }
+
+    iterator end() const
+    { return iterator(); }
+
+    // typed iteration, skipping the entries that do not convert:
+    //
+    //     for ( const auto& e : t.entries<std::string, int>() )
+    //         counts[e.key] += e.value;
+    template<typename K, typename V>
+    TableRange<K, V> entries() const
+    { return TableRange<K, V>(L, util::abs_index(L, index())); }
+};
+
+}
+
+#endif
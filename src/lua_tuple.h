@@ -0,0 +1,149 @@
+#ifndef LUA_TUPLE_H
+#define LUA_TUPLE_H
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <luajit-2.0/lua.hpp>
+
+#include "lua_stack_api.h"
+#include "lua_util.h"
+
+namespace Ltl
+{
+
+namespace detail
+{
+
+// std::tuple and std::pair are not tables. they are pushed as multiple
+// values, and cast from consecutive stack slots
+struct tuple_tag {};
+
+template<typename T>
+struct is_tuple
+{ static constexpr bool value = false; };
+
+template<typename... Ts>
+struct is_tuple<std::tuple<Ts...>>
+{ static constexpr bool value = true; };
+
+template<typename A, typename B>
+struct is_tuple<std::pair<A, B>>
+{ static constexpr bool value = true; };
+
+template<size_t I, size_t N>
+struct TupleElements
+{
+    template<typename T>
+    static void push(lua_State* L, T&& v)
+    {
+        Ltl::push(L, std::get<I>(std::forward<T>(v)));
+        TupleElements<I + 1, N>::push(L, std::forward<T>(v));
+    }
+
+    // n is the slot of element I. an element takes PushCount slots (a nested
+    // tuple takes one per element)
+    template<typename T>
+    static void cast(lua_State* L, int n, T& out)
+    {
+        using element_type = typename std::tuple_element<I, T>::type;
+        std::get<I>(out) = Ltl::cast<element_type>(L, n);
+        TupleElements<I + 1, N>::cast(L, n + PushCount<element_type>::value, out);
+    }
+
+    template<typename T>
+    static bool try_cast(lua_State* L, int n, T& out)
+    {
+        using element_type = typename std::tuple_element<I, T>::type;
+
+        auto r = Ltl::try_cast<element_type>(L, n);
+        if ( !r.ok )
+            return false;
+
+        std::get<I>(out) = std::move(r.value);
+        return TupleElements<I + 1, N>::try_cast(L, n + PushCount<element_type>::value, out);
+    }
+};
+
+template<size_t N>
+struct TupleElements<N, N>
+{
+    template<typename T>
+    static void push(lua_State*, T&&)
+    { }
+
+    template<typename T>
+    static void cast(lua_State*, int, T&)
+    { }
+
+    template<typename T>
+    static bool try_cast(lua_State*, int, T&)
+    { return true; }
+};
+
+template<typename T>
+using tuple_elements_t = TupleElements<0, std::tuple_size<T>::value>;
+
+template<>
+struct PushPolicy<tuple_tag>
+{
+    template<typename T, typename U>
+    static void push(lua_State* L, U&& v)
+    {
+        luaL_checkstack(L, PushCount<T>::value + push_scratch, "too many values to push");
+        tuple_elements_t<T>::push(L, std::forward<U>(v));
+    }
+};
+
+template<>
+struct CastPolicy<tuple_tag>
+{
+    template<typename T>
+    static T cast(lua_State* L, int n)
+    {
+        T out;
+        tuple_elements_t<T>::cast(L, util::abs_index(L, n), out);
+        return out;
+    }
+};
+
+template<>
+struct TryCastPolicy<tuple_tag>
+{
+    template<typename T>
+    static CastResult<T> try_cast(lua_State* L, int n)
+    {
+        T out;
+        if ( !tuple_elements_t<T>::try_cast(L, util::abs_index(L, n), out) )
+            return { T(), false };
+
+        return { std::move(out), true };
+    }
+};
+
+template<typename T>
+struct PushTrait<T, typename std::enable_if<is_tuple<T>::value>::type>
+{ using tag = tuple_tag; };
+
+template<typename T>
+struct CastTrait<T, typename std::enable_if<is_tuple<T>::value>::type>
+{ using tag = tuple_tag; };
+
+template<typename T>
+struct TryCastTrait<T, typename std::enable_if<is_tuple<T>::value>::type>
+{ using tag = tuple_tag; };
+
+template<typename... Ts>
+struct PushCount<std::tuple<Ts...>>
+{ static constexpr int value = TotalPushCount<Ts...>::value; };
+
+template<typename A, typename B>
+struct PushCount<std::pair<A, B>>
+{ static constexpr int value = TotalPushCount<A, B>::value; };
+
+} // namespace detail
+
+}
+
+#endif
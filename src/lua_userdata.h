@@ -3,8 +3,10 @@
 
 #include <cassert>
 #include <string>
+#include <type_traits>
 #include <luajit-2.0/lua.hpp>
 #include "lua_ref.h"
+#include "lua_util.h"
 
 namespace Ltl
 {
@@ -14,6 +16,51 @@ namespace detail
 
 struct userdata_tag {};
 
+// Push the metatable registered for userdata handle type T (or nil if T has
+// not been registered in this state).
+//
+// The metatable is cached in the registry under a light userdata key that is
+// unique to T. This makes the lookup a pointer-keyed raw get (no string
+// hashing and no allocations). The cache is normally populated by
+// ClassRegistrar::open(). Otherwise the first lookup falls back to the named
+// metatable and caches it.
+template<typename T>
+static inline void push_metatable(lua_State* L)
+{
+    lua_pushlightuserdata(L, T::metatable_key());
+    lua_rawget(L, LUA_REGISTRYINDEX);
+
+    if ( !lua_isnil(L, -1) )
+        return;
+
+    lua_pop(L, 1);
+
+    const std::string& name = T::get_type_name();
+    if ( name.empty() )
+    {
+        lua_pushnil(L);
+        return;
+    }
+
+    luaL_getmetatable(L, name.c_str());
+    if ( lua_istable(L, -1) )
+    {
+        lua_pushlightuserdata(L, T::metatable_key());
+        lua_pushvalue(L, -2);
+        lua_rawset(L, LUA_REGISTRYINDEX);
+    }
+}
+
+// Associate the metatable at index n with userdata handle type T
+template<typename T>
+static inline void cache_metatable(lua_State* L, int n)
+{
+    n = util::abs_index(L, n);
+    lua_pushlightuserdata(L, T::metatable_key());
+    lua_pushvalue(L, n);
+    lua_rawset(L, LUA_REGISTRYINDEX);
+}
+
 template<>
 struct TypePolicy<userdata_tag>
 {
@@ -23,27 +70,15 @@ struct TypePolicy<userdata_tag>
         if ( lua_type(L, n) != LUA_TUSERDATA )
             return false;
 
-        std::string name = T::userdata_type_name;
-        if ( name.empty() )
-            return false;
-
-        luaL_getmetatable(L, name.c_str());
-        // userdata type is not registered in Lua
-        if ( lua_isnil(L, -1) )
-        {
-            lua_pop(L, 1);
+        // userdata has no metatable
+        if ( !lua_getmetatable(L, n) )
             return false;
-        }
-
-        lua_getmetatable(L, n);
-        if ( !lua_equal(L, -1, -2) )
-        {
-            lua_pop(L, 2);
-            return false;
-        }
 
+        push_metatable<T>(L);
+        bool match = lua_rawequal(L, -1, -2);
         lua_pop(L, 2);
-        return true;
+
+        return match;
     }
 };
 
@@ -51,8 +86,8 @@ template<>
 struct NamePolicy<userdata_tag>
 {
     template<typename T>
-    static std::string name(lua_State*, int)
-    { return "Userdata<" + T::userdata_type_name + ">"; }
+    static const char* name(lua_State*, int)
+    { return T::get_display_name().c_str(); }
 };
 
 } // namespace detail
@@ -80,11 +115,25 @@ public:
     { return *get_ptr(); }
 
     static void set_type_name(std::string name)
-    { Userdata<Class>::userdata_type_name = name; }
+    {
+        Userdata<Class>::userdata_type_name = name;
+        get_display_name() = "Userdata<" + name + ">";
+    }
 
     static std::string& get_type_name()
     { return Userdata<Class>::userdata_type_name; }
 
+    // the name used in error messages. built once, when the type name is set
+    static std::string& get_display_name()
+    {
+        static std::string display_name = "Userdata<>";
+        return display_name;
+    }
+
+    // unique registry key for the cached metatable of this type
+    static void* metatable_key()
+    { return &Userdata<Class>::userdata_type_name; }
+
 private:
     Class* get_ptr()
     {
@@ -94,6 +143,12 @@ private:
     }
 };
 
+// like Ref, handles are passed by value (the class does not affect the layout)
+static_assert(std::is_trivially_copyable<Userdata<detail::userdata_tag>>::value,
+    "Userdata must be trivially copyable");
+static_assert(sizeof(Userdata<detail::userdata_tag>) <= 16,
+    "Userdata must fit in two registers");
+
 // FIXIT-H: will this be visible in all TUs?
 // Will be set by userdata class registration
 template<typename Class>
@@ -0,0 +1,225 @@
+#ifndef LUA_WEAK_REF_H
+#define LUA_WEAK_REF_H
+
+#include <luajit-2.0/lua.hpp>
+
+#include "lua_ref.h"
+#include "lua_function.h"
+#include "lua_table.h"
+
+namespace Ltl
+{
+
+namespace detail
+{
+
+// the weak-valued table that holds the objects of all weak references of a
+// lua_State. it is anchored in the registry with luaL_ref, and its registry
+// slot is found through key() when a reference is created. slots are
+// integers: released slots are chained from t[0], and t[-1] counts the slots
+// ever handed out
+struct WeakRegistry
+{
+    static void* key()
+    {
+        static char k;
+        return &k;
+    }
+
+    // the registry slot of the table, created on first use
+    static int ref(lua_State* L)
+    {
+        lua_pushlightuserdata(L, key());
+        lua_rawget(L, LUA_REGISTRYINDEX);
+
+        int id = static_cast<int>(lua_tointeger(L, -1));
+        lua_pop(L, 1);
+
+        if ( id )
+            return id;
+
+        lua_newtable(L);
+        lua_newtable(L);
+        lua_pushliteral(L, "v");
+        lua_setfield(L, -2, "__mode");
+        lua_setmetatable(L, -2);
+        id = luaL_ref(L, LUA_REGISTRYINDEX);
+
+        lua_pushlightuserdata(L, key());
+        lua_pushinteger(L, id);
+        lua_rawset(L, LUA_REGISTRYINDEX);
+
+        return id;
+    }
+
+    // store the value at index n in a free slot. a slot whose object was
+    // collected is not reused until it is released
+    static int acquire(lua_State* L, int table, int n)
+    {
+        n = util::abs_index(L, n);
+        lua_rawgeti(L, LUA_REGISTRYINDEX, table);
+        int t = lua_gettop(L);
+
+        lua_rawgeti(L, t, 0);
+        int id = static_cast<int>(lua_tointeger(L, -1));
+        lua_pop(L, 1);
+
+        if ( id )
+        {
+            // unlink it from the free list
+            lua_rawgeti(L, t, id);
+            lua_rawseti(L, t, 0);
+        }
+        else
+        {
+            lua_rawgeti(L, t, -1);
+            id = static_cast<int>(lua_tointeger(L, -1)) + 1;
+            lua_pop(L, 1);
+
+            lua_pushinteger(L, id);
+            lua_rawseti(L, t, -1);
+        }
+
+        lua_pushvalue(L, n);
+        lua_rawseti(L, t, id);
+        lua_pop(L, 1);
+
+        return id;
+    }
+
+    static void release(lua_State* L, int table, int id)
+    {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, table);
+        lua_rawgeti(L, -1, 0);
+        lua_rawseti(L, -2, id);
+        lua_pushinteger(L, id);
+        lua_rawseti(L, -2, 0);
+        lua_pop(L, 1);
+    }
+};
+
+} // namespace detail
+
+// a reference to a lua object that does not keep it alive. the object is held
+// by a weak-valued table, so it can be collected once nothing else refers to
+// it. caches of callbacks and tables can hold these instead of Persistents:
+//
+//     Ltl::WeakFunc cached(f);
+//     ...
+//     Ltl::Func f = cached.lock();
+//     if ( f.valid() )
+//         f.call(event);
+//
+// only collectable values (tables, functions, userdata and threads) ever
+// expire. like Persistent, a Weak must be destroyed (or reset) before its
+// lua_State is closed
+template<typename Handle>
+class Weak
+{
+public:
+    // default ctor creates an empty reference
+    Weak() : L { nullptr }, table { LUA_NOREF }, id { 0 } { }
+
+    // refer to the value at index n
+    Weak(lua_State* L, int n) :
+        L { L }, table { detail::WeakRegistry::ref(L) }, id { 0 }
+    { id = detail::WeakRegistry::acquire(L, table, n); }
+
+    // refer to the value h refers to. an invalid handle gives an empty
+    // reference
+    explicit Weak(const Handle& h) : Weak()
+    {
+        if ( h.valid() )
+            *this = Weak(h.state(), h.index());
+    }
+
+    Weak(const Weak&) = delete;
+    Weak& operator=(const Weak&) = delete;
+
+    Weak(Weak&& other) noexcept :
+        L { other.L }, table { other.table }, id { other.id }
+    {
+        other.L = nullptr;
+        other.id = 0;
+    }
+
+    Weak& operator=(Weak&& other) noexcept
+    {
+        if ( this != &other )
+        {
+            reset();
+            L = other.L;
+            table = other.table;
+            id = other.id;
+            other.L = nullptr;
+            other.id = 0;
+        }
+
+        return *this;
+    }
+
+    ~Weak()
+    { reset(); }
+
+    // release the slot
+    void reset()
+    {
+        if ( L )
+            detail::WeakRegistry::release(L, table, id);
+
+        L = nullptr;
+        id = 0;
+    }
+
+    // true if the reference was created from a value. the object may have
+    // been collected since (see lock())
+    bool valid() const
+    { return L && id; }
+
+    // the slot in the weak table (0 when empty)
+    int slot() const
+    { return id; }
+
+    lua_State* state() const
+    { return L; }
+
+    // push the object onto the stack of a state that shares a registry with
+    // the one the reference was created in, and return a handle to it. if the
+    // reference is empty or the object was collected, nothing is pushed and
+    // the handle is invalid
+    Handle lock(lua_State* to) const
+    {
+        if ( !valid() )
+            return Handle();
+
+        // two raw gets: the registry holds its values strongly, so the object
+        // lives in the weak table, which has to be on the stack to be indexed
+        lua_rawgeti(to, LUA_REGISTRYINDEX, table);
+        lua_rawgeti(to, -1, id);
+        lua_replace(to, -2);
+
+        if ( lua_isnil(to, -1) )
+        {
+            lua_pop(to, 1);
+            return Handle();
+        }
+
+        return Handle(to, lua_gettop(to));
+    }
+
+    Handle lock() const
+    { return lock(L); }
+
+private:
+    lua_State* L;
+    int table;
+    int id;
+};
+
+using WeakRef = Weak<Ref>;
+using WeakFunc = Weak<Func>;
+using WeakTable = Weak<Table>;
+
+}
+
+#endif
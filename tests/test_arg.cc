@@ -0,0 +1,148 @@
+#include <cstring>
+#include <string>
+#include "test_common.h"
+
+namespace
+{
+class Scaler
+{
+public:
+    int factor = 2;
+
+    int scale(int v, int offset)
+    { return v * factor + offset; }
+};
+}
+
+TEST_CASE( "Arg", "[arg]" )
+{
+    Vm lua;
+    lua_pushinteger(lua, 7);
+    lua_pushstring(lua, "seven");
+    lua_pushboolean(lua, 1);
+    lua_pushnumber(lua, -2.5);
+
+    SECTION( "size and bottom" )
+    {
+        Ltl::Arg all(lua);
+        CHECK( all.size() == 4 );
+        CHECK( all.index(1) == 1 );
+
+        Ltl::Arg rest(lua, 3);
+        CHECK( rest.size() == 2 );
+        CHECK( rest.index(1) == 3 );
+        CHECK( rest.get<bool>(1) );
+
+        Ltl::Arg none(lua, 6);
+        CHECK( none.size() == 0 );
+    }
+
+    SECTION( "conversions" )
+    {
+        Ltl::Arg arg(lua);
+
+        int i = arg[1];
+        std::string s = arg[2];
+        bool b = arg[3];
+        double d = arg[4];
+
+        CHECK( i == 7 );
+        CHECK( s == "seven" );
+        CHECK( b );
+        CHECK( d == -2.5 );
+
+        CHECK( arg[1].as<unsigned>() == 7 );
+        CHECK( arg.get<Ltl::StringView>(2).size() == 5 );
+        CHECK( std::strcmp(arg.get<const char*>(2), "seven") == 0 );
+        CHECK( arg[4].as<int>() == -2 );
+        CHECK( lua_gettop(lua) == 4 );
+    }
+
+    SECTION( "types" )
+    {
+        Ltl::Arg arg(lua);
+
+        CHECK( arg.type(1) == LUA_TNUMBER );
+        CHECK( arg[2].type() == LUA_TSTRING );
+        CHECK( arg.type(5) == LUA_TNONE );
+        CHECK( arg.type(20) == LUA_TNONE );
+    }
+
+    SECTION( "mismatches" )
+    {
+        Ltl::Arg arg(lua);
+
+        // strict, like try_cast: no numeric strings, no negative unsigned
+        CHECK( arg.get<int>(2) == 0 );
+        CHECK( arg.get<std::string>(1).empty() );
+        CHECK( arg.get<unsigned>(4) == 0 );
+        CHECK( arg.get<int>(5) == 0 );
+
+        CHECK_THROWS_AS( arg.check<bool>(1), Ltl::TypeError );
+        CHECK_THROWS_AS( arg.check<unsigned>(4), Ltl::TypeError );
+        CHECK_THROWS_AS( arg.check<int>(5), Ltl::TypeError );
+
+        try
+        {
+            arg.check<int>(2);
+            FAIL( "no TypeError" );
+        }
+        catch ( const Ltl::TypeError& e )
+        {
+            CHECK( e.index == 2 );
+            CHECK( e.actual == LUA_TSTRING );
+        }
+    }
+
+    SECTION( "slots are read once" )
+    {
+        Ltl::Arg arg(lua);
+        CHECK( arg[2].as<std::string>() == "seven" );
+
+        // the cached value is used even though the stack slot changed
+        lua_pushinteger(lua, 8);
+        lua_replace(lua, 2);
+
+        CHECK( arg[2].as<std::string>() == "seven" );
+        CHECK( arg.type(2) == LUA_TSTRING );
+
+        // unread slots come from the stack
+        lua_pushinteger(lua, 9);
+        lua_replace(lua, 1);
+        CHECK( arg[1].as<int>() == 9 );
+    }
+
+    SECTION( "slots beyond the inline buffer" )
+    {
+        for ( int i = 5; i <= 10; ++i )
+            lua_pushinteger(lua, i);
+
+        Ltl::Arg arg(lua);
+        CHECK( arg.size() == 10 );
+        CHECK( arg[8].as<int>() == 8 );
+        CHECK( arg[10].as<int>() == 10 );
+        CHECK( arg.get<int>(11) == 0 );
+        CHECK_THROWS_AS( arg.check<std::string>(9), Ltl::TypeError );
+    }
+
+    SECTION( "bound functor" )
+    {
+        Ltl::register_class<Scaler>(lua, "Scaler")
+            .add_ctor<>()
+            .add_function("scale", [](Ltl::Arg& arg, Scaler* self)
+            { return self->scale(arg[1], arg[2].as<int>() + 1); })
+            .add_function("count", [](Ltl::Arg& arg, Scaler*)
+            { return arg.size(); });
+
+        luaL_dostring(lua,
+            "s = Scaler.new() "
+            "v = s:scale(5, 2) "
+            "n = s:count(1, 'a', nil)");
+
+        CHECK( Ltl::get_global<int>(lua, "v") == 13 );
+        CHECK( Ltl::get_global<int>(lua, "n") == 3 );
+
+        CHECK( luaL_dostring(lua, "s:scale('x', 1)") );
+        CHECK( std::strstr(lua_tostring(lua, -1), "TypeError") );
+    }
+}
@@ -0,0 +1,187 @@
+#include <iterator>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "test_common.h"
+
+TEST_CASE( "CallSite", "[callsite]" )
+{
+    Vm lua(true);
+    luaL_dostring(lua,
+        "function classify(proto, port) return proto .. ':' .. port end "
+        "function add(a, b) return a + b end "
+        "function pair(a) return a, a * 2 end "
+        "function fail() error('boom') end "
+        "calls = 0 "
+        "function count() calls = calls + 1 end"
+    );
+    lua_settop(lua, 0);
+
+    auto get = [&](const char* name) {
+        lua_getglobal(lua, name);
+        return Ltl::Func(lua, lua_gettop(lua));
+    };
+
+    SECTION( "invalid function" )
+    {
+        lua_pushinteger(lua, 1);
+        Ltl::CallSite<int()> site(Ltl::Func(lua, 1));
+        CHECK( !site.valid() );
+    }
+
+    SECTION( "outlives the stack slot" )
+    {
+        Ltl::CallSite<int(int, int)> add(get("add"));
+        lua_settop(lua, 0);
+
+        REQUIRE( add.valid() );
+
+        auto r = add(2, 3);
+        CHECK( r.ok() );
+        CHECK( r.value == 5 );
+        CHECK( lua_gettop(lua) == 0 );
+    }
+
+    SECTION( "bound leading arguments" )
+    {
+        Ltl::CallSite<std::string(int)> classify(get("classify"), std::string("tcp"));
+        lua_settop(lua, 0);
+
+        CHECK( classify(80).value == "tcp:80" );
+        CHECK( classify(443).value == "tcp:443" );
+        CHECK( lua_gettop(lua) == 0 );
+    }
+
+    SECTION( "multiple results" )
+    {
+        Ltl::CallSite<std::tuple<int, int>(int)> pair(get("pair"));
+        CHECK( pair(4).value == std::make_tuple(4, 8) );
+    }
+
+    SECTION( "no results" )
+    {
+        Ltl::CallSite<void()> count(get("count"));
+        CHECK( count().ok() );
+        CHECK( count().ok() );
+
+        lua_getglobal(lua, "calls");
+        CHECK( lua_tointeger(lua, -1) == 2 );
+    }
+
+    SECTION( "errors" )
+    {
+        Ltl::CallSite<int()> fail(get("fail"));
+        int top = lua_gettop(lua);
+
+        auto r = fail();
+        CHECK( r.status == LUA_ERRRUN );
+        CHECK( r.error.find("boom") != std::string::npos );
+        CHECK( r.error.find("stack traceback") != std::string::npos );
+        CHECK( lua_gettop(lua) == top );
+    }
+
+    SECTION( "checked results" )
+    {
+        Ltl::CallSite<int(std::string), Ltl::Checked> classify(get("classify"), "udp");
+        int top = lua_gettop(lua);
+
+        auto r = classify("x");
+        CHECK( r.status == Ltl::lua_errresult );
+        CHECK( lua_gettop(lua) == top );
+    }
+
+    SECTION( "move" )
+    {
+        Ltl::CallSite<int(int, int)> a(get("add"));
+        Ltl::CallSite<int(int, int)> b(std::move(a));
+
+        CHECK( !a.valid() );
+        CHECK( b(1, 1).value == 2 );
+    }
+}
+
+TEST_CASE( "call_batch", "[callsite]" )
+{
+    Vm lua(true);
+    luaL_dostring(lua,
+        "function classify(port) "
+        "   if port < 0 then error('bad port') end "
+        "   return port > 1024 "
+        "end "
+        "function add(a, b) return a + b end"
+    );
+    lua_settop(lua, 0);
+
+    lua_pushinteger(lua, 7);
+
+    SECTION( "per element results" )
+    {
+        lua_getglobal(lua, "classify");
+        Ltl::Func classify(lua, -1);
+        int top = lua_gettop(lua);
+
+        std::vector<int> ports { 80, 8080, -1, 443 };
+        std::vector<Ltl::CallResult<bool>> results;
+
+        auto n = Ltl::call_batch<bool>(
+            classify, ports.begin(), ports.end(), std::back_inserter(results));
+
+        CHECK( n == 3 );
+        CHECK( lua_gettop(lua) == top );
+
+        REQUIRE( results.size() == 4 );
+        CHECK( results[0].ok() );
+        CHECK( results[0].value == false );
+        CHECK( results[1].value == true );
+        CHECK( results[2].status == LUA_ERRRUN );
+        CHECK( results[2].error.find("bad port") != std::string::npos );
+        CHECK( results[3].ok() );
+        CHECK( results[3].value == false );
+    }
+
+    SECTION( "tuple elements are passed as arguments" )
+    {
+        lua_getglobal(lua, "add");
+        Ltl::Func add(lua, -1);
+
+        std::vector<std::tuple<int, int>> in { std::make_tuple(1, 2), std::make_tuple(3, 4) };
+        Ltl::CallResult<int> out[2];
+
+        CHECK( Ltl::call_batch<int>(add, in.begin(), in.end(), out) == 2 );
+        CHECK( out[0].value == 3 );
+        CHECK( out[1].value == 7 );
+    }
+
+    SECTION( "function at a pseudo-index" )
+    {
+        lua_getglobal(lua, "add");
+        lua_pushcclosure(lua, [](lua_State* L)
+        {
+            std::tuple<int, int> in[] { std::make_tuple(1, 2), std::make_tuple(5, 6) };
+            Ltl::CallResult<int> out[2];
+
+            Ltl::call_batch<int>(Ltl::Func(L, lua_upvalueindex(1)), in, in + 2, out);
+            lua_pushinteger(L, out[0].value + out[1].value);
+            return 1;
+        }, 1);
+
+        lua_call(lua, 0, 1);
+        CHECK( lua_tointeger(lua, -1) == 14 );
+    }
+
+    SECTION( "empty range" )
+    {
+        lua_getglobal(lua, "add");
+        Ltl::Func add(lua, -1);
+        int top = lua_gettop(lua);
+
+        std::vector<int> in;
+        std::vector<Ltl::CallResult<int>> out;
+
+        CHECK( Ltl::call_batch<int>(add, in.begin(), in.end(), std::back_inserter(out)) == 0 );
+        CHECK( out.empty() );
+        CHECK( lua_gettop(lua) == top );
+    }
+
+    CHECK( lua_tointeger(lua, 1) == 7 );
+}
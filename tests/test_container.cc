@@ -0,0 +1,164 @@
+#include "test_common.h"
+#include <array>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+class RegisteredType
+{
+public:
+    int v = 0;
+};
+}
+
+TEST_CASE( "Stack API for sequence containers", "[stack_api][container]" )
+{
+    Vm lua;
+    std::vector<int> v { 1, 2, 3 };
+
+    Ltl::push(lua, v);
+
+    SECTION( "push" )
+    {
+        REQUIRE( lua_istable(lua, -1) );
+        CHECK( lua_objlen(lua, -1) == 3 );
+
+        lua_rawgeti(lua, -1, 2);
+        CHECK( lua_tointeger(lua, -1) == 2 );
+    }
+
+    SECTION( "type" )
+    {
+        CHECK( Ltl::type<std::vector<int>>(lua, -1) );
+        CHECK( !Ltl::type<std::vector<int>>(lua, 0) );
+    }
+
+    SECTION( "cast" )
+    {
+        CHECK( Ltl::cast<std::vector<int>>(lua, -1) == v );
+        CHECK( Ltl::cast<std::vector<double>>(lua, -1).size() == 3 );
+        CHECK( Ltl::cast<std::vector<std::string>>(lua, -1) ==
+            std::vector<std::string>(3) );
+    }
+
+    SECTION( "try_cast" )
+    {
+        auto r = Ltl::try_cast<std::vector<int>>(lua, -1);
+        CHECK( r.ok );
+        CHECK( r.value == v );
+
+        CHECK( !Ltl::try_cast<std::vector<std::string>>(lua, -1) );
+        CHECK( (Ltl::try_cast<std::array<int, 3>>(lua, -1)) );
+        CHECK( !(Ltl::try_cast<std::array<int, 2>>(lua, -1)) );
+    }
+
+    SECTION( "check" )
+    {
+        CHECK( Ltl::check<std::vector<int>>(lua, 1) == v );
+        CHECK_THROWS_AS( Ltl::check<std::vector<bool>>(lua, 1), Ltl::TypeError );
+    }
+
+    SECTION( "zero" )
+    {
+        CHECK( Ltl::zero<std::vector<int>>(lua, 0).empty() );
+    }
+
+    SECTION( "name" )
+    {
+        CHECK( std::string(Ltl::name<std::vector<int>>(lua, 0)) == "table" );
+    }
+
+    SECTION( "stack is preserved" )
+    {
+        int top = lua_gettop(lua);
+        Ltl::try_cast<std::vector<int>>(lua, -1);
+        Ltl::try_cast<std::vector<bool>>(lua, -1);
+        CHECK( lua_gettop(lua) == top );
+    }
+}
+
+TEST_CASE( "Stack API for std::array", "[stack_api][container]" )
+{
+    Vm lua;
+    std::array<std::string, 2> v {{ "foo", "bar" }};
+
+    Ltl::push(lua, v);
+    CHECK( lua_objlen(lua, -1) == 2 );
+    CHECK( (Ltl::cast<std::array<std::string, 2>>(lua, -1) == v) );
+}
+
+TEST_CASE( "Stack API for nested containers", "[stack_api][container]" )
+{
+    Vm lua;
+    std::vector<std::vector<int>> v { { 1 }, { 2, 3 } };
+
+    Ltl::push(lua, v);
+
+    auto r = Ltl::try_cast<std::vector<std::vector<int>>>(lua, -1);
+    CHECK( r.ok );
+    CHECK( r.value == v );
+}
+
+TEST_CASE( "Stack API for map containers", "[stack_api][container]" )
+{
+    Vm lua;
+    std::map<std::string, int> m { { "a", 1 }, { "b", 2 } };
+
+    Ltl::push(lua, m);
+
+    SECTION( "push" )
+    {
+        lua_getfield(lua, -1, "b");
+        CHECK( lua_tointeger(lua, -1) == 2 );
+    }
+
+    SECTION( "cast" )
+    {
+        CHECK( (Ltl::cast<std::map<std::string, int>>(lua, -1) == m) );
+
+        auto u = Ltl::cast<std::unordered_map<std::string, int>>(lua, -1);
+        CHECK( u.size() == 2 );
+        CHECK( u["a"] == 1 );
+    }
+
+    SECTION( "try_cast" )
+    {
+        CHECK( (Ltl::try_cast<std::map<std::string, int>>(lua, -1)) );
+        CHECK( !(Ltl::try_cast<std::map<int, int>>(lua, -1)) );
+        CHECK( !(Ltl::try_cast<std::map<std::string, bool>>(lua, -1)) );
+    }
+
+    SECTION( "stack is preserved" )
+    {
+        int top = lua_gettop(lua);
+        Ltl::try_cast<std::map<std::string, int>>(lua, -1);
+        Ltl::try_cast<std::map<std::string, bool>>(lua, -1);
+        CHECK( lua_gettop(lua) == top );
+    }
+}
+
+TEST_CASE( "Sequence of userdata", "[container][userdata]" )
+{
+    Vm lua;
+    PointerManager<RegisteredType> a, b;
+    register_userdata<RegisteredType>(lua, "RegisteredType");
+
+    lua_newtable(lua);
+    *create_userdata<RegisteredType>(lua) = a;
+    lua_rawseti(lua, 1, 1);
+    *create_userdata<RegisteredType>(lua) = b;
+    lua_rawseti(lua, 1, 2);
+
+    auto r = Ltl::try_cast<std::vector<RegisteredType*>>(lua, 1);
+    REQUIRE( r.ok );
+    REQUIRE( r.value.size() == 2 );
+    CHECK( r.value[0] == a );
+    CHECK( r.value[1] == b );
+
+    allocate_userdata<RegisteredType>(lua);
+    lua_rawseti(lua, 1, 3);
+    CHECK( !Ltl::try_cast<std::vector<RegisteredType*>>(lua, 1) );
+}
@@ -34,7 +34,7 @@ TEST_CASE( "Stack API for Func", "[stack_api][func]" )
 
     SECTION( "name" )
     {
-        CHECK( Ltl::name<Ltl::Func>(lua, -1) == "function" );
+        CHECK( std::string(Ltl::name<Ltl::Func>(lua, -1)) == "function" );
     }
 }
 
@@ -49,3 +49,124 @@ TEST_CASE( "Func members", "[func]" )
     func.invalidate();
     CHECK( !func.valid() );
 }
+
+TEST_CASE( "Func calls", "[func]" )
+{
+    Vm lua(true);
+    luaL_dostring(lua,
+        "function add(a, b) return a + b end "
+        "function swap(a, b) return b, a end "
+        "function fail(msg) error(msg) end "
+        "function throw_table() error({}) end "
+        "function nothing() end "
+        "function greet(n) return 'hello ' .. n, n end"
+    );
+
+    auto get = [&](const char* name) {
+        lua_getglobal(lua, name);
+        return Ltl::Func(lua, lua_gettop(lua));
+    };
+
+    SECTION( "call" )
+    {
+        auto add = get("add");
+        int top = lua_gettop(lua);
+
+        CHECK( add.call<int>(1, 2) == 3 );
+        CHECK( lua_gettop(lua) == top );
+
+        auto r = get("swap").call<int, std::string>("x", 4);
+        CHECK( std::get<0>(r) == 4 );
+        CHECK( std::get<1>(r) == "x" );
+
+        get("nothing").call<>();
+    }
+
+    SECTION( "pcall" )
+    {
+        auto add = get("add");
+        int top = lua_gettop(lua);
+
+        auto r = add.pcall<double>(1.5, 2);
+        CHECK( r.ok() );
+        CHECK( r.value == 3.5 );
+        CHECK( lua_gettop(lua) == top );
+
+        auto t = get("swap").pcall<int, int>(std::make_tuple(1, 2));
+        REQUIRE( t );
+        CHECK( t.value == std::make_tuple(2, 1) );
+    }
+
+    SECTION( "pcall errors" )
+    {
+        auto fail = get("fail");
+        int top = lua_gettop(lua);
+
+        auto r = fail.pcall<>("boom");
+        CHECK( !r.ok() );
+        CHECK( r.status == LUA_ERRRUN );
+        CHECK( r.error.find("boom") != std::string::npos );
+        CHECK( r.error.find("stack traceback") != std::string::npos );
+        CHECK( lua_gettop(lua) == top );
+
+        auto t = get("throw_table").pcall<>();
+        CHECK( t.status == LUA_ERRRUN );
+        CHECK( t.error == "(error object is not a string)" );
+    }
+
+    SECTION( "pcall result type mismatch" )
+    {
+        auto swap = get("swap");
+        int top = lua_gettop(lua);
+
+        auto r = swap.pcall<int, int>("x", 1);
+        CHECK( r.status == Ltl::lua_errresult );
+        CHECK( !r.error.empty() );
+        CHECK( lua_gettop(lua) == top );
+
+        r = swap.pcall<int, int>(1, 2);
+        CHECK( r.ok() );
+    }
+
+    SECTION( "string results outlive the call" )
+    {
+        auto greet = get("greet");
+
+        auto s = greet.call<std::string>(1);
+        auto r = greet.pcall<std::string, int>(2);
+
+        // the result strings are no longer referenced by lua
+        luaL_dostring(lua, "collectgarbage()");
+
+        CHECK( s == "hello 1" );
+        REQUIRE( r );
+        CHECK( std::get<0>(r.value) == "hello 2" );
+    }
+
+    SECTION( "pcall through relative and pseudo-indices" )
+    {
+        lua_getglobal(lua, "add");
+        CHECK( Ltl::Func(lua, -1).pcall<int>(1, 2).value == 3 );
+
+        lua_getglobal(lua, "add");
+        lua_pushcclosure(lua, [](lua_State* L)
+        {
+            auto r = Ltl::Func(L, lua_upvalueindex(1)).pcall<int>(3, 4);
+            lua_pushinteger(L, r.ok() ? r.value : -1);
+            return 1;
+        }, 1);
+
+        lua_call(lua, 0, 1);
+        CHECK( lua_tointeger(lua, -1) == 7 );
+    }
+
+    SECTION( "error handler is cached" )
+    {
+        auto fail = get("fail");
+        fail.pcall<>("first");
+
+        lua_pushlightuserdata(lua, Ltl::detail::ErrorHandler::key());
+        lua_rawget(lua, LUA_REGISTRYINDEX);
+        CHECK( lua_iscfunction(lua, -1) );
+    }
+}
@@ -0,0 +1,77 @@
+#include <cstring>
+#include <string>
+#include "test_common.h"
+
+TEST_CASE( "Key", "[key]" )
+{
+    Vm lua;
+    Ltl::Key timeout(lua, "timeout");
+
+    SECTION( "push" )
+    {
+        CHECK( timeout.valid() );
+        CHECK( timeout.size() == 7 );
+        CHECK( std::strcmp(timeout.c_str(), "timeout") == 0 );
+
+        Ltl::push(lua, timeout);
+        CHECK( lua_gettop(lua) == 1 );
+        CHECK( std::string(lua_tostring(lua, -1)) == "timeout" );
+
+        // the interned string is the one pushed
+        CHECK( lua_tostring(lua, -1) == timeout.c_str() );
+    }
+
+    SECTION( "embedded nul" )
+    {
+        Ltl::Key k(lua, std::string("a\0b", 3));
+        Ltl::push(lua, k);
+
+        size_t len = 0;
+        lua_tolstring(lua, -1, &len);
+        CHECK( len == 3 );
+    }
+
+    SECTION( "fields" )
+    {
+        lua_newtable(lua);
+        int top = lua_gettop(lua);
+
+        Ltl::set_field(lua, -1, timeout, 30);
+        CHECK( Ltl::get_field<int>(lua, -1, "timeout") == 30 );
+        CHECK( Ltl::get_field<int>(lua, 1, timeout) == 30 );
+
+        Ltl::set_field(lua, 1, "timeout", 45);
+        CHECK( Ltl::get_field<int>(lua, -1, timeout) == 45 );
+        CHECK( lua_gettop(lua) == top );
+    }
+
+    SECTION( "fields invoke metamethods" )
+    {
+        lua_newtable(lua);
+        luaL_loadstring(lua, "return { __index = function(t, k) return #k end }");
+        lua_call(lua, 0, 1);
+        lua_setmetatable(lua, -2);
+
+        CHECK( Ltl::get_field<int>(lua, -1, timeout) == 7 );
+    }
+
+    SECTION( "globals" )
+    {
+        Ltl::set_global(lua, timeout, 10);
+        CHECK( Ltl::get_global<int>(lua, "timeout") == 10 );
+
+        Ltl::set_global(lua, "timeout", 20);
+        CHECK( Ltl::get_global<int>(lua, timeout) == 20 );
+        CHECK( lua_gettop(lua) == 0 );
+    }
+
+    SECTION( "table accessors" )
+    {
+        lua_newtable(lua);
+        Ltl::Table table(lua, -1);
+
+        table.set(timeout, 5);
+        CHECK( table.get<int>("timeout") == 5 );
+        CHECK( table.get<int>(timeout) == 5 );
+    }
+}
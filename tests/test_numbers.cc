@@ -0,0 +1,124 @@
+#include "test_common.h"
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+TEST_CASE( "bulk numeric arrays", "[numbers]" )
+{
+    Vm lua;
+
+    // crosses several staging blocks and leaves a partial one at the end
+    const size_t count = 1000;
+
+    std::vector<double> in(count);
+    for ( size_t i = 0; i < count; ++i )
+        in[i] = static_cast<double>(i) + 0.25;
+
+    Ltl::push_numbers(lua, in.data(), in.size());
+    REQUIRE( lua_istable(lua, -1) );
+    CHECK( lua_objlen(lua, -1) == count );
+
+    SECTION( "round trip" )
+    {
+        std::vector<double> d(count);
+        CHECK( Ltl::read_numbers(lua, -1, d.data(), count) == count );
+        CHECK( d == in );
+
+        std::vector<float> f(count);
+        CHECK( Ltl::read_numbers(lua, -1, f.data(), count) == count );
+        CHECK( f[999] == 999.25f );
+
+        std::vector<int32_t> i32(count);
+        CHECK( Ltl::read_numbers(lua, -1, i32.data(), count) == count );
+        CHECK( i32[0] == 0 );
+        CHECK( i32[999] == 999 );
+
+        std::vector<uint16_t> u16(count);
+        CHECK( Ltl::read_numbers(lua, -1, u16.data(), count) == count );
+        CHECK( u16[513] == 513 );
+
+        CHECK( lua_gettop(lua) == 1 );
+    }
+
+    SECTION( "non-number element" )
+    {
+        lua_pushstring(lua, "x");
+        lua_rawseti(lua, -2, 700);
+
+        std::vector<int32_t> out(count);
+        CHECK( Ltl::read_numbers(lua, -1, out.data(), count) == 699 );
+        CHECK( out[698] == 698 );
+        CHECK( lua_gettop(lua) == 1 );
+    }
+
+    SECTION( "short table" )
+    {
+        std::vector<float> out(count + 10);
+        CHECK( Ltl::read_numbers(lua, -1, out.data(), out.size()) == count );
+    }
+
+    SECTION( "out of range" )
+    {
+        lua_pushnumber(lua, 70000);
+        lua_rawseti(lua, -2, 300);
+
+        std::vector<uint16_t> u16(count);
+        CHECK( Ltl::read_numbers(lua, -1, u16.data(), count) == 299 );
+
+        std::vector<int32_t> i32(count);
+        CHECK( Ltl::read_numbers(lua, -1, i32.data(), count) == count );
+
+        lua_pushnumber(lua, -1);
+        lua_rawseti(lua, -2, 3);
+        CHECK( Ltl::read_numbers(lua, -1, u16.data(), count) == 2 );
+
+        lua_pushnumber(lua, 4294967296.0);
+        lua_rawseti(lua, -2, 2);
+        CHECK( Ltl::read_numbers(lua, -1, i32.data(), count) == 1 );
+
+        lua_pushnumber(lua, std::nan(""));
+        lua_rawseti(lua, -2, 1);
+        CHECK( Ltl::read_numbers(lua, -1, i32.data(), count) == 0 );
+
+        // floating point targets are not range checked
+        std::vector<float> f(count);
+        CHECK( Ltl::read_numbers(lua, -1, f.data(), count) == count );
+    }
+
+    SECTION( "not a table" )
+    {
+        lua_pushnumber(lua, 1);
+
+        int32_t out[1] = { 9 };
+        CHECK( Ltl::read_numbers(lua, -1, out, 1) == Ltl::not_a_table );
+        CHECK( out[0] == 9 );
+
+        // distinct from a table whose first element is not a number
+        lua_newtable(lua);
+        lua_pushstring(lua, "x");
+        lua_rawseti(lua, -2, 1);
+        CHECK( Ltl::read_numbers(lua, -1, out, 1) == 0 );
+        lua_pop(lua, 1);
+
+        const int32_t ints[] = { 1 };
+        CHECK( !Ltl::write_numbers(lua, -1, ints, 1) );
+        CHECK( lua_tonumber(lua, -1) == 1 );
+        CHECK( lua_gettop(lua) == 2 );
+    }
+
+    SECTION( "write into an existing table" )
+    {
+        const int32_t ints[] = { 5, -6, 7 };
+        CHECK( Ltl::write_numbers(lua, -1, ints, 3) );
+
+        lua_rawgeti(lua, -1, 2);
+        CHECK( lua_tonumber(lua, -1) == -6 );
+        lua_pop(lua, 1);
+
+        lua_rawgeti(lua, -1, 4);
+        CHECK( lua_tonumber(lua, -1) == 3.25 );
+        lua_pop(lua, 1);
+
+        CHECK( lua_gettop(lua) == 1 );
+    }
+}
@@ -0,0 +1,103 @@
+#include <utility>
+#include "test_common.h"
+
+TEST_CASE( "Stack API for Persistent", "[stack_api][persistent]" )
+{
+    Vm lua;
+    lua_pushinteger(lua, 42);
+
+    Ltl::PersistentRef ref(lua, -1);
+    lua_settop(lua, 0);
+
+    SECTION( "push" )
+    {
+        Ltl::push(lua, ref);
+        CHECK( lua_gettop(lua) == 1 );
+        CHECK( lua_tointeger(lua, -1) == 42 );
+    }
+
+    SECTION( "get" )
+    {
+        auto r = ref.get();
+        CHECK( r.index() == lua_gettop(lua) );
+        CHECK( r.to<int>() == 42 );
+    }
+}
+
+TEST_CASE( "Persistent lifetime", "[persistent]" )
+{
+    Vm lua;
+
+    SECTION( "empty" )
+    {
+        Ltl::PersistentRef ref;
+        CHECK( !ref.valid() );
+
+        ref.push(lua);
+        CHECK( lua_isnil(lua, -1) );
+    }
+
+    SECTION( "invalid handle" )
+    {
+        lua_pushinteger(lua, 1);
+        Ltl::PersistentFunc func(Ltl::Func(lua, 1));
+        CHECK( !func.valid() );
+    }
+
+    SECTION( "outlives the stack slot" )
+    {
+        luaL_loadstring(lua, "return 7");
+        Ltl::PersistentFunc func(Ltl::Func(lua, -1));
+        lua_settop(lua, 0);
+
+        REQUIRE( func.valid() );
+
+        auto f = func.get();
+        CHECK( Ltl::type<Ltl::Func>(lua, f.index()) );
+        lua_call(lua, 0, 1);
+        CHECK( lua_tointeger(lua, -1) == 7 );
+    }
+
+    SECTION( "move" )
+    {
+        lua_newtable(lua);
+        Ltl::PersistentTable a(Ltl::Table(lua, -1));
+        lua_pop(lua, 1);
+
+        int id = a.ref();
+        Ltl::PersistentTable b(std::move(a));
+
+        CHECK( !a.valid() );
+        CHECK( b.valid() );
+        CHECK( b.ref() == id );
+
+        Ltl::PersistentTable c;
+        c = std::move(b);
+
+        CHECK( !b.valid() );
+        CHECK( c.ref() == id );
+
+        c.get();
+        CHECK( lua_istable(lua, -1) );
+    }
+
+    SECTION( "release recycles registry slots" )
+    {
+        lua_newtable(lua);
+        int id;
+
+        {
+            Ltl::PersistentRef ref(lua, -1);
+            id = ref.ref();
+        }
+
+        Ltl::PersistentRef ref(lua, -1);
+        CHECK( ref.ref() == id );
+
+        lua_rawgeti(lua, LUA_REGISTRYINDEX, id);
+        CHECK( lua_rawequal(lua, -1, -2) );
+
+        ref.reset();
+        CHECK( !ref.valid() );
+    }
+}
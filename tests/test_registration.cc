@@ -1,6 +1,8 @@
 #include "test_common.h"
 #include <cstring>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 #include <iostream>
 
@@ -65,10 +67,38 @@ public:
     void noop()
     { std::cout << "NOOOOOOPE" << std::endl; }
 
-    int sum() { return x + y; }
+    int sum() const { return x + y; }
     void set(int t1, int t2) { x = t1; y = t2; }
     bool ordered(bool reverse) { return reverse ? x >= y : x <= y; }
 
+    std::tuple<double, double, double, double> bounds() const
+    { return std::make_tuple(x, y, x + 1, y + 1); }
+
+    std::pair<std::string, int> label(const std::string& prefix) const
+    { return { prefix + std::to_string(x), y }; }
+
+    int dot(const UserType& other) const
+    { return x * other.x + y * other.y; }
+
+    static int twice(int v) { return 2 * v; }
+
+    int scale(int factor, int offset) const
+    { return sum() * factor + offset; }
+
+    void move(int dx, Ltl::Opt<int> dy)
+    { x += dx; y += dy.value_or(dx); }
+
+    static std::string greet(std::string who, std::string greeting)
+    { return greeting + " " + who; }
+
+    // more results than LUA_MINSTACK
+    static std::tuple<int, int, int, int, int, int, int, int, int, int, int, int,
+        int, int, int, int, int, int, int, int, int, int, int, int> many()
+    {
+        return std::make_tuple(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12,
+            13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24);
+    }
+
     EventTracker* events = nullptr;
 
     int x, y;
@@ -225,3 +255,135 @@ TEST_CASE( "lua userdata registration with custom ctor" )
     //     CHECK( ut.y == 5 );
     // }
 }
+
+TEST_CASE( "lua userdata registration member functions" )
+{
+    Vm lua(true);
+
+    // the argument errors below are only raised in Checked mode
+    Ltl::register_class<UserType, Ltl::Checked>(lua, "UserType")
+        .add_ctor<int, int>()
+        .add_function("sum", &UserType::sum)
+        .add_function("set", &UserType::set)
+        .add_function("ordered", &UserType::ordered)
+        .add_function("bounds", &UserType::bounds)
+        .add_function("label", &UserType::label)
+        .add_function("dot", &UserType::dot)
+        .add_static_function("twice", &UserType::twice)
+        .add_function("scale", &UserType::scale, Ltl::defaults(10, 0))
+        .add_function("move", &UserType::move)
+        .add_static_function("greet", &UserType::greet, Ltl::defaults("hello"))
+        .add_static_function("many", &UserType::many);
+
+    execute_lua(lua, "ut = UserType.new(1, 2)");
+
+    SECTION( "return values" )
+    {
+        assert_lua(lua, "ut:sum() == 3");
+        assert_lua(lua, "ut:ordered(false) == true");
+        assert_lua(lua, "ut:ordered(true) == false");
+        assert_lua(lua, "UserType.twice(21) == 42");
+    }
+
+    SECTION( "void return" )
+    {
+        execute_lua(lua, "ut:set(5, 7)");
+        assert_lua(lua, "select('#', ut:set(5, 7)) == 0");
+
+        auto& ut = fetch_userdata<UserType>(lua, "ut");
+        CHECK( ut.x == 5 );
+        CHECK( ut.y == 7 );
+    }
+
+    SECTION( "tuple return" )
+    {
+        assert_lua(lua, "select('#', ut:bounds()) == 4");
+        execute_lua(lua, "x0, y0, x1, y1 = ut:bounds()");
+        assert_lua(lua, "x0 == 1 and y0 == 2 and x1 == 2 and y1 == 3");
+
+        execute_lua(lua, "s, n = ut:label('x=')");
+        assert_lua(lua, "s == 'x=1' and n == 2");
+
+        assert_lua(lua, "select('#', UserType.many()) == 24");
+        assert_lua(lua, "select(24, UserType.many()) == 24");
+    }
+
+    SECTION( "userdata argument" )
+    {
+        execute_lua(lua, "other = UserType.new(3, 4)");
+        assert_lua(lua, "ut:dot(other) == 11");
+    }
+
+    SECTION( "default arguments" )
+    {
+        assert_lua(lua, "ut:scale() == 30");
+        assert_lua(lua, "ut:scale(2) == 6");
+        assert_lua(lua, "ut:scale(2, 1) == 7");
+        assert_lua(lua, "ut:scale(nil, 1) == 31");
+        assert_lua(lua, "UserType.greet('lua') == 'hello lua'");
+        assert_lua(lua, "UserType.greet('lua', 'hi') == 'hi lua'");
+        assert_lua(lua, "not pcall(UserType.greet)");
+        assert_lua(lua, "not pcall(ut.scale, ut, 'a')");
+    }
+
+    SECTION( "optional arguments" )
+    {
+        execute_lua(lua, "ut:move(1)");
+        execute_lua(lua, "ut:move(1, nil)");
+        execute_lua(lua, "ut:move(1, 10)");
+
+        auto& ut = fetch_userdata<UserType>(lua, "ut");
+        CHECK( ut.x == 4 );
+        CHECK( ut.y == 14 );
+
+        assert_lua(lua, "not pcall(ut.move, ut, 1, 'a')");
+    }
+
+    SECTION( "type errors are raised as lua errors" )
+    {
+        assert_lua(lua, "not pcall(ut.set, ut, 'a', 1)");
+        assert_lua(lua, "not pcall(ut.sum, 1)");
+        assert_lua(lua, "not pcall(UserType.new, 'a')");
+    }
+}
+
+TEST_CASE( "lua userdata registration in trusted mode" )
+{
+    Vm lua(true);
+
+    Ltl::register_class<UserType, Ltl::Trusted>(lua, "UserType")
+        .add_ctor<int, int>()
+        .add_function("sum", &UserType::sum)
+        .add_function("set", &UserType::set)
+        .add_function("dot", &UserType::dot)
+        .add_function("scale", &UserType::scale, Ltl::defaults(10, 0))
+        .add_function("move", &UserType::move);
+
+    execute_lua(lua, "ut = UserType.new(1, 2)");
+
+    SECTION( "arguments" )
+    {
+        execute_lua(lua, "ut:set(3, 4)");
+        assert_lua(lua, "ut:sum() == 7");
+        assert_lua(lua, "ut:dot(UserType.new(1, 1)) == 7");
+        assert_lua(lua, "ut:scale() == 70");
+        assert_lua(lua, "ut:scale(1, 1) == 8");
+
+        execute_lua(lua, "ut:move(1)");
+        assert_lua(lua, "ut:sum() == 9");
+    }
+
+    SECTION( "self is always checked" )
+    {
+        assert_lua(lua, "not pcall(ut.sum, 1)");
+        assert_lua(lua, "not pcall(ut.scale)");
+        assert_lua(lua, "not pcall(ut.move, UserType, 1)");
+    }
+
+#ifndef NDEBUG
+    SECTION( "debug builds keep checking" )
+    {
+        assert_lua(lua, "not pcall(ut.set, ut, 'a', 1)");
+    }
+#endif
+}
@@ -85,3 +85,72 @@ TEST_CASE ( "implicit conversion", "[sandbox]" )
 
     // FIXIT-M check<T&> and check<T*> not supported
 }
+
+TEST_CASE ( "string view arguments", "[sandbox]" )
+{
+    Vm lua;
+    lua_pushstring(lua, "a request body");
+
+    const char* original = lua_tostring(lua, 1);
+
+    auto rv = Ltl::detail::ArgumentApplier<1, const char*, Ltl::StringView>::apply(
+        lua, [](Ltl::StringView body) { return body.data(); });
+
+    // no copy was made
+    CHECK( rv == original );
+
+    lua_pushinteger(lua, 1);
+    CHECK_THROWS_AS( Ltl::check<Ltl::StringView>(lua, 2), Ltl::TypeError );
+}
+
+TEST_CASE ( "optional arguments", "[sandbox]" )
+{
+    Vm lua;
+    lua_pushinteger(lua, 3);
+    lua_pushnil(lua);
+
+    auto present = Ltl::check<Ltl::Opt<int>>(lua, 1);
+    CHECK( present );
+    CHECK( present.value() == 3 );
+
+    CHECK( !Ltl::check<Ltl::Opt<int>>(lua, 2) );
+    CHECK( !Ltl::check<Ltl::Opt<int>>(lua, 3) );
+    CHECK( Ltl::check<Ltl::Opt<int>>(lua, 3).value_or(7) == 7 );
+
+    CHECK_THROWS_AS( Ltl::check<Ltl::Opt<std::string>>(lua, 1), Ltl::TypeError );
+    CHECK_THROWS_AS( Ltl::check<Ltl::Opt<RegisteredType>>(lua, 1), Ltl::TypeError );
+}
+
+TEST_CASE ( "type error messages", "[sandbox]" )
+{
+    Vm lua;
+    lua_pushstring(lua, "eighty");
+
+    try
+    {
+        Ltl::check<int>(lua, 1);
+        FAIL( "check did not throw" );
+    }
+    catch ( Ltl::TypeError& e )
+    {
+        CHECK( e.index == 1 );
+        CHECK( e.actual == LUA_TSTRING );
+        CHECK( std::string(e.expected) == "integer" );
+        CHECK( std::string(e.what()) ==
+            "TypeError: expected integer, got string (index 1)" );
+
+        // the message is formatted once
+        CHECK( e.what() == e.what() );
+    }
+
+    try
+    {
+        Ltl::check<UnregisteredType>(lua, 2);
+        FAIL( "check did not throw" );
+    }
+    catch ( Ltl::TypeError& e )
+    {
+        CHECK( std::string(e.what()) ==
+            "TypeError: expected Userdata<>, got no value (index 2)" );
+    }
+}
@@ -1,4 +1,6 @@
 #include "test_common.h"
+#include <cstdint>
+#include <limits>
 
 TEST_CASE ( "Stack API for integral types", "[stack_api]")
 {
@@ -23,6 +25,16 @@ TEST_CASE ( "Stack API for integral types", "[stack_api]")
         CHECK( Ltl::cast<int>(lua, -1) == v );
     }
 
+    SECTION( "try_cast" )
+    {
+        auto r = Ltl::try_cast<int>(lua, -1);
+        CHECK( r.ok );
+        CHECK( r.value == v );
+
+        CHECK( !Ltl::try_cast<unsigned>(lua, -1) );
+        CHECK( !Ltl::try_cast<int>(lua, 0) );
+    }
+
     SECTION( "zero" )
     {
         CHECK( Ltl::zero<int>(lua, 0) == 0 );
@@ -30,7 +42,7 @@ TEST_CASE ( "Stack API for integral types", "[stack_api]")
 
     SECTION( "name" )
     {
-        CHECK( Ltl::name<int>(lua, 0) == "integer" );
+        CHECK( std::string(Ltl::name<int>(lua, 0)) == "integer" );
     }
 }
 
@@ -56,6 +68,15 @@ TEST_CASE ( "Stack API for floating point types", "[stack_api]")
         CHECK( Ltl::cast<float>(lua, -1) == v );
     }
 
+    SECTION( "try_cast" )
+    {
+        auto r = Ltl::try_cast<float>(lua, -1);
+        CHECK( r.ok );
+        CHECK( r.value == v );
+
+        CHECK( !Ltl::try_cast<bool>(lua, -1) );
+    }
+
     SECTION( "zero" )
     {
         CHECK( Ltl::zero<float>(lua, 0) == 0.0f );
@@ -63,7 +84,7 @@ TEST_CASE ( "Stack API for floating point types", "[stack_api]")
 
     SECTION( "name" )
     {
-        CHECK( Ltl::name<float>(lua, 0) == "number" );
+        CHECK( std::string(Ltl::name<float>(lua, 0)) == "number" );
     }
 }
 
@@ -89,6 +110,15 @@ TEST_CASE ( "Stack API for boolean types", "[stack_api]")
         CHECK( Ltl::cast<bool>(lua, -1) == v );
     }
 
+    SECTION( "try_cast" )
+    {
+        auto r = Ltl::try_cast<bool>(lua, -1);
+        CHECK( r.ok );
+        CHECK( r.value == v );
+
+        CHECK( !Ltl::try_cast<int>(lua, -1) );
+    }
+
     SECTION( "zero" )
     {
         CHECK( Ltl::zero<bool>(lua, 0) == false );
@@ -96,7 +126,7 @@ TEST_CASE ( "Stack API for boolean types", "[stack_api]")
 
     SECTION( "name" )
     {
-        CHECK( Ltl::name<bool>(lua, 0) == "boolean" );
+        CHECK( std::string(Ltl::name<bool>(lua, 0)) == "boolean" );
     }
 }
 
@@ -123,6 +153,15 @@ TEST_CASE ( "Stack API for pointer types", "[stack_api]")
         CHECK( Ltl::cast<void*>(lua, -1) == v );
     }
 
+    SECTION( "try_cast" )
+    {
+        auto r = Ltl::try_cast<void*>(lua, -1);
+        CHECK( r.ok );
+        CHECK( r.value == v );
+
+        CHECK( !Ltl::try_cast<void*>(lua, 0) );
+    }
+
     SECTION( "zero" )
     {
         CHECK( Ltl::zero<void*>(lua, 0) == nullptr );
@@ -130,7 +169,7 @@ TEST_CASE ( "Stack API for pointer types", "[stack_api]")
 
     SECTION( "name" )
     {
-        CHECK( Ltl::name<void*>(lua, 0) == "pointer" );
+        CHECK( std::string(Ltl::name<void*>(lua, 0)) == "pointer" );
     }
 }
 
@@ -144,7 +183,8 @@ TEST_CASE ( "Stack API for string types", "[stack_api]")
     SECTION( "push" )
     {
         size_t len = 0;
-        std::string r(lua_tolstring(lua, -1, &len), len);
+        const char* s = lua_tolstring(lua, -1, &len);
+        std::string r(s, len);
         CHECK( r == v );
     }
 
@@ -158,6 +198,17 @@ TEST_CASE ( "Stack API for string types", "[stack_api]")
         CHECK( Ltl::cast<std::string>(lua, -1) == v );
     }
 
+    SECTION( "try_cast" )
+    {
+        auto r = Ltl::try_cast<std::string>(lua, -1);
+        CHECK( r.ok );
+        CHECK( r.value == v );
+
+        // numbers are not implicitly converted
+        lua_pushinteger(lua, 1);
+        CHECK( !Ltl::try_cast<std::string>(lua, -1) );
+    }
+
     SECTION( "zero" )
     {
         CHECK( Ltl::zero<std::string>(lua, 0) == "" );
@@ -165,7 +216,7 @@ TEST_CASE ( "Stack API for string types", "[stack_api]")
 
     SECTION( "name" )
     {
-        CHECK( Ltl::name<std::string>(lua, 0) == "string" );
+        CHECK( std::string(Ltl::name<std::string>(lua, 0)) == "string" );
     }
 }
 
@@ -193,6 +244,13 @@ TEST_CASE ( "Stack API for cstring types", "[stack_api]")
         CHECK( r == v );
     }
 
+    SECTION( "try_cast" )
+    {
+        auto r = Ltl::try_cast<const char*>(lua, -1);
+        REQUIRE( r.ok );
+        CHECK( std::string(r.value) == v );
+    }
+
     SECTION( "zero" )
     {
         std::string r = Ltl::zero<const char*>(lua, 0);
@@ -201,6 +259,468 @@ TEST_CASE ( "Stack API for cstring types", "[stack_api]")
 
     SECTION( "name" )
     {
-        CHECK( Ltl::name<const char*>(lua, 0) == "string" );
+        CHECK( std::string(Ltl::name<const char*>(lua, 0)) == "string" );
+    }
+}
+
+TEST_CASE ( "Extended stack API", "[stack_api]" )
+{
+    Vm lua;
+    lua_pushinteger(lua, -42);
+    lua_pushstring(lua, "foo");
+
+    SECTION( "get" )
+    {
+        CHECK( Ltl::get<int>(lua, 1) == -42 );
+        CHECK( Ltl::get<int>(lua, 2) == 0 );
+        CHECK( Ltl::get<unsigned>(lua, 1) == 0 );
+        CHECK( Ltl::get<std::string>(lua, 2) == "foo" );
+    }
+
+    SECTION( "get_default" )
+    {
+        CHECK( Ltl::get_default<int>(lua, 1, 7) == -42 );
+        CHECK( Ltl::get_default<int>(lua, 2, 7) == 7 );
+        CHECK( Ltl::get_default<int>(lua, 3, 7) == 7 );
+    }
+}
+
+TEST_CASE ( "Stack API for string view types", "[stack_api]")
+{
+    Vm lua;
+    std::string s("foo\0bar", 7);
+    Ltl::StringView v(s);
+
+    Ltl::push(lua, v);
+
+    SECTION( "push" )
+    {
+        size_t len = 0;
+        const char* p = lua_tolstring(lua, -1, &len);
+        CHECK( std::string(p, len) == s );
+    }
+
+    SECTION( "type" )
+    {
+        CHECK( Ltl::type<Ltl::StringView>(lua, -1) );
+    }
+
+    SECTION( "cast" )
+    {
+        auto r = Ltl::cast<Ltl::StringView>(lua, -1);
+        CHECK( r == v );
+
+        // refers to the lua string directly
+        CHECK( r.data() == lua_tostring(lua, -1) );
+    }
+
+    SECTION( "try_cast" )
+    {
+        auto r = Ltl::try_cast<Ltl::StringView>(lua, -1);
+        CHECK( r.ok );
+        CHECK( r.value.size() == 7 );
+        CHECK( r.value.str() == s );
+
+        lua_pushinteger(lua, 1);
+        CHECK( !Ltl::try_cast<Ltl::StringView>(lua, -1) );
+    }
+
+    SECTION( "zero" )
+    {
+        CHECK( Ltl::zero<Ltl::StringView>(lua, 0).empty() );
+    }
+
+    SECTION( "name" )
+    {
+        CHECK( std::string(Ltl::name<Ltl::StringView>(lua, 0)) == "string" );
+    }
+}
+
+TEST_CASE ( "Stack API for 64-bit integer types", "[stack_api]")
+{
+    Vm lua(true);
+
+    const int64_t big = INT64_C(0x123456789abcdef1);
+    const uint64_t ubig = UINT64_C(0xfedcba9876543210);
+
+    SECTION( "push" )
+    {
+        Ltl::push(lua, Ltl::Int64(-42));
+        CHECK( lua_type(lua, -1) == LUA_TNUMBER );
+        CHECK( lua_tonumber(lua, -1) == -42 );
+
+        Ltl::push(lua, Ltl::Int64(big));
+        CHECK( lua_type(lua, -1) == Ltl::lua_tcdata );
+
+        Ltl::push(lua, Ltl::UInt64(ubig));
+        CHECK( lua_type(lua, -1) == Ltl::lua_tcdata );
+    }
+
+    SECTION( "plain 64-bit integers are numbers" )
+    {
+        Ltl::push(lua, size_t(3));
+        CHECK( lua_type(lua, -1) == LUA_TNUMBER );
+        lua_setglobal(lua, "count");
+        CHECK( !luaL_dostring(lua, "assert(count == 3)") );
+
+        Ltl::push(lua, int64_t(1) << 40);
+        CHECK( lua_type(lua, -1) == LUA_TNUMBER );
+        CHECK( Ltl::cast<int64_t>(lua, -1) == int64_t(1) << 40 );
+        CHECK( Ltl::cast<uint64_t>(lua, -1) == uint64_t(1) << 40 );
+
+        lua_pushnumber(lua, -1);
+        CHECK( !Ltl::type<uint64_t>(lua, -1) );
+        CHECK( !Ltl::type<Ltl::UInt64>(lua, -1) );
+    }
+
+    SECTION( "round trip" )
+    {
+        Ltl::push(lua, Ltl::Int64(big));
+        CHECK( Ltl::cast<Ltl::Int64>(lua, -1) == big );
+
+        Ltl::push(lua, Ltl::UInt64(ubig));
+        CHECK( Ltl::cast<Ltl::UInt64>(lua, -1) == ubig );
+
+        Ltl::push(lua, Ltl::Int64(std::numeric_limits<int64_t>::min()));
+        CHECK( Ltl::cast<Ltl::Int64>(lua, -1) == std::numeric_limits<int64_t>::min() );
+
+        Ltl::push(lua, Ltl::UInt64(7));
+        CHECK( Ltl::cast<Ltl::UInt64>(lua, -1) == 7 );
+    }
+
+    SECTION( "arithmetic in lua" )
+    {
+        Ltl::push(lua, Ltl::Int64(big));
+        lua_setglobal(lua, "counter");
+
+        REQUIRE( !luaL_dostring(lua, "counter = counter + 1") );
+        lua_getglobal(lua, "counter");
+        CHECK( Ltl::cast<Ltl::Int64>(lua, -1) == big + 1 );
+
+        REQUIRE( !luaL_dostring(lua, "return 0x7fffffffffffffffULL") );
+        CHECK( Ltl::cast<Ltl::UInt64>(lua, -1) == UINT64_C(0x7fffffffffffffff) );
+    }
+
+    SECTION( "type" )
+    {
+        Ltl::push(lua, Ltl::Int64(big));
+        CHECK( Ltl::type<Ltl::Int64>(lua, -1) );
+        CHECK( Ltl::type<Ltl::UInt64>(lua, -1) );
+
+        lua_pushnumber(lua, -1);
+        CHECK( Ltl::type<Ltl::Int64>(lua, -1) );
+        CHECK( !Ltl::type<Ltl::UInt64>(lua, -1) );
+
+        lua_pushnumber(lua, 1e30);
+        CHECK( !Ltl::type<Ltl::Int64>(lua, -1) );
+
+        lua_pushstring(lua, "1");
+        CHECK( !Ltl::type<Ltl::Int64>(lua, -1) );
+    }
+
+    SECTION( "try_cast" )
+    {
+        Ltl::push(lua, Ltl::UInt64(ubig));
+        auto r = Ltl::try_cast<Ltl::UInt64>(lua, -1);
+        CHECK( r.ok );
+        CHECK( r.value == ubig );
+
+        REQUIRE( !luaL_dostring(lua, "return require('ffi').new('int[1]')") );
+        CHECK( lua_type(lua, -1) == Ltl::lua_tcdata );
+        CHECK( !Ltl::try_cast<Ltl::Int64>(lua, -1) );
+
+        lua_pushnumber(lua, 1e30);
+        CHECK( !Ltl::try_cast<Ltl::UInt64>(lua, -1) );
+
+        // the ffi checker does not disturb the stack
+        CHECK( lua_gettop(lua) == 3 );
+    }
+
+    SECTION( "signedness" )
+    {
+        // a uint64_t box above INT64_MAX does not fit an int64_t
+        Ltl::push(lua, Ltl::UInt64(std::numeric_limits<uint64_t>::max()));
+        CHECK( !Ltl::try_cast<Ltl::Int64>(lua, -1) );
+        CHECK( !Ltl::type<Ltl::Int64>(lua, -1) );
+        CHECK( Ltl::cast<Ltl::Int64>(lua, -1) == 0 );
+        CHECK( Ltl::try_cast<Ltl::UInt64>(lua, -1).value == std::numeric_limits<uint64_t>::max() );
+
+        // a negative int64_t box does not fit a uint64_t
+        Ltl::push(lua, Ltl::Int64(-(INT64_C(1) << 60)));
+        CHECK( !Ltl::try_cast<Ltl::UInt64>(lua, -1) );
+        CHECK( !Ltl::type<Ltl::UInt64>(lua, -1) );
+        CHECK( Ltl::cast<Ltl::UInt64>(lua, -1) == 0 );
+        CHECK( Ltl::try_cast<Ltl::Int64>(lua, -1).value == -(INT64_C(1) << 60) );
+
+        // boxes of the other signedness convert when the value fits
+        Ltl::push(lua, Ltl::UInt64(ubig >> 1));
+        auto r = Ltl::try_cast<Ltl::Int64>(lua, -1);
+        CHECK( r.ok );
+        CHECK( r.value == int64_t(ubig >> 1) );
+
+        Ltl::push(lua, Ltl::Int64(big));
+        auto u = Ltl::try_cast<Ltl::UInt64>(lua, -1);
+        CHECK( u.ok );
+        CHECK( u.value == uint64_t(big) );
+    }
+
+    SECTION( "other cdata" )
+    {
+        // the payload of other ctypes is not read
+        REQUIRE( !luaL_dostring(lua, "return require('ffi').new('int8_t', 5)") );
+        CHECK( Ltl::cast<Ltl::Int64>(lua, -1) == 0 );
+        CHECK( !Ltl::type<Ltl::UInt64>(lua, -1) );
+
+        REQUIRE( !luaL_dostring(lua, "return require('ffi').new('struct { int a; }')") );
+        CHECK( Ltl::cast<Ltl::UInt64>(lua, -1) == 0 );
+        CHECK( !Ltl::try_cast<Ltl::Int64>(lua, -1) );
+    }
+
+    SECTION( "name" )
+    {
+        CHECK( std::string(Ltl::name<Ltl::Int64>(lua, 0)) == "int64" );
+        CHECK( std::string(Ltl::name<Ltl::UInt64>(lua, 0)) == "uint64" );
+    }
+}
+
+namespace
+{
+enum class Proto { TCP, UDP, ICMP };
+enum Action { DROP = 4, ALERT = 7 };
+}
+
+TEST_CASE ( "Stack API for enum types", "[stack_api]")
+{
+    Ltl::Enum<Proto>::define({
+        { "tcp", Proto::TCP },
+        { "udp", Proto::UDP },
+        { "icmp", Proto::ICMP }
+    });
+
+    Ltl::Enum<Action>::define({ { "drop", DROP }, { "alert", ALERT } });
+
+    Vm lua;
+
+    Ltl::push(lua, Proto::UDP);
+
+    SECTION( "push" )
+    {
+        CHECK( std::string(lua_tostring(lua, -1)) == "udp" );
+
+        Ltl::push(lua, ALERT);
+        CHECK( std::string(lua_tostring(lua, -1)) == "alert" );
+
+        Ltl::push(lua, static_cast<Proto>(42));
+        CHECK( lua_isnil(lua, -1) );
+    }
+
+    SECTION( "type" )
+    {
+        CHECK( Ltl::type<Proto>(lua, -1) );
+        CHECK( !Ltl::type<Action>(lua, -1) );
+    }
+
+    SECTION( "cast" )
+    {
+        CHECK( Ltl::cast<Proto>(lua, -1) == Proto::UDP );
+
+        lua_pushstring(lua, "drop");
+        CHECK( Ltl::cast<Action>(lua, -1) == DROP );
+    }
+
+    SECTION( "try_cast" )
+    {
+        auto r = Ltl::try_cast<Proto>(lua, -1);
+        CHECK( r.ok );
+        CHECK( r.value == Proto::UDP );
+
+        // the same name built at runtime is the same interned string
+        std::string name = "ic";
+        name += "mp";
+        lua_pushlstring(lua, name.data(), name.size());
+        CHECK( Ltl::try_cast<Proto>(lua, -1).value == Proto::ICMP );
+
+        lua_pushstring(lua, "sctp");
+        CHECK( !Ltl::try_cast<Proto>(lua, -1) );
+
+        lua_pushlstring(lua, "tcp\0x", 5);
+        CHECK( !Ltl::try_cast<Proto>(lua, -1) );
+
+        lua_pushinteger(lua, 0);
+        CHECK( !Ltl::try_cast<Proto>(lua, -1) );
+
+        // the name cache does not disturb the stack
+        CHECK( lua_gettop(lua) == 5 );
+    }
+
+    SECTION( "check" )
+    {
+        CHECK( Ltl::check<Proto>(lua, -1) == Proto::UDP );
+
+        lua_pushstring(lua, "sctp");
+        CHECK_THROWS_AS( Ltl::check<Proto>(lua, -1), Ltl::TypeError );
+    }
+
+    SECTION( "defined again after use" )
+    {
+        CHECK( Ltl::cast<Proto>(lua, -1) == Proto::UDP );
+
+        // more names, in another order
+        Ltl::Enum<Proto>::define({
+            { "tcp", Proto::UDP },
+            { "icmp", Proto::ICMP },
+            { "udp", Proto::TCP },
+            { "sctp", static_cast<Proto>(9) }
+        });
+
+        CHECK( Ltl::cast<Proto>(lua, -1) == Proto::TCP );
+
+        lua_pushstring(lua, "sctp");
+        CHECK( Ltl::cast<Proto>(lua, -1) == static_cast<Proto>(9) );
+    }
+
+    SECTION( "per state cache" )
+    {
+        Vm other;
+        lua_pushstring(other, "tcp");
+        CHECK( Ltl::cast<Proto>(other, -1) == Proto::TCP );
+        CHECK( Ltl::cast<Proto>(lua, -1) == Proto::UDP );
+
+        // the cached names survive a full collection
+        lua_gc(other, LUA_GCCOLLECT, 0);
+        lua_pushstring(other, "icmp");
+        CHECK( Ltl::cast<Proto>(other, -1) == Proto::ICMP );
+    }
+
+    SECTION( "zero" )
+    {
+        CHECK( Ltl::zero<Proto>(lua, 0) == Proto::TCP );
+    }
+
+    SECTION( "name" )
+    {
+        CHECK( std::string(Ltl::name<Proto>(lua, 0)) == "string" );
+    }
+}
+
+namespace
+{
+struct tracked_tag {};
+
+struct Tracked
+{
+    using push_tag = tracked_tag;
+
+    Tracked(int v) : v { v } { }
+    Tracked(const Tracked& o) : v { o.v } { ++copies; }
+
+    int v;
+    static int copies;
+};
+
+int Tracked::copies = 0;
+}
+
+namespace Ltl
+{
+namespace detail
+{
+template<>
+struct PushPolicy<tracked_tag>
+{
+    template<typename T>
+    static void push(lua_State* L, const T& v)
+    { lua_pushinteger(L, v.v); }
+};
+}
+}
+
+TEST_CASE ( "push forwarding", "[stack_api]" )
+{
+    Vm lua;
+    Tracked::copies = 0;
+
+    Tracked t(1);
+    const Tracked& ct = t;
+
+    Ltl::push(lua, t);
+    Ltl::push(lua, ct);
+    Ltl::push(lua, Tracked(2));
+
+    CHECK( Tracked::copies == 0 );
+    CHECK( lua_gettop(lua) == 3 );
+    CHECK( lua_tointeger(lua, 3) == 2 );
+}
+
+TEST_CASE ( "push_all", "[stack_api]" )
+{
+    Vm lua;
+    std::string s = "foo";
+    Tracked::copies = 0;
+
+    int n = Ltl::push_all(lua, 1, 2.5, true, s, "bar", Tracked(3));
+
+    CHECK( n == 6 );
+    CHECK( lua_gettop(lua) == 6 );
+    CHECK( Tracked::copies == 0 );
+
+    CHECK( lua_tointeger(lua, 1) == 1 );
+    CHECK( lua_tonumber(lua, 2) == 2.5 );
+    CHECK( lua_toboolean(lua, 3) );
+    CHECK( Ltl::cast<std::string>(lua, 4) == s );
+    CHECK( Ltl::cast<std::string>(lua, 5) == "bar" );
+    CHECK( lua_tointeger(lua, 6) == 3 );
+
+    CHECK( Ltl::push_all(lua) == 0 );
+    CHECK( lua_gettop(lua) == 6 );
+}
+
+TEST_CASE ( "Stack API for tuples", "[stack_api]" )
+{
+    Vm lua;
+    auto v = std::make_tuple(1, std::string("foo"), true);
+
+    Ltl::push(lua, v);
+
+    SECTION( "push" )
+    {
+        CHECK( lua_gettop(lua) == 3 );
+        CHECK( lua_tointeger(lua, 1) == 1 );
+        CHECK( Ltl::cast<std::string>(lua, 2) == "foo" );
+        CHECK( lua_toboolean(lua, 3) );
+    }
+
+    SECTION( "cast" )
+    {
+        CHECK( (Ltl::cast<std::tuple<int, std::string, bool>>(lua, 1) == v) );
+        CHECK( (Ltl::cast<std::pair<std::string, bool>>(lua, -2) ==
+            std::make_pair(std::string("foo"), true)) );
+    }
+
+    SECTION( "try_cast" )
+    {
+        CHECK( (Ltl::try_cast<std::tuple<int, std::string, bool>>(lua, 1)) );
+        CHECK( !(Ltl::try_cast<std::tuple<int, int, bool>>(lua, 1)) );
+    }
+
+    SECTION( "nested" )
+    {
+        // a nested tuple takes one slot per element
+        using nested = std::tuple<int, std::pair<std::string, bool>, int>;
+
+        lua_pushinteger(lua, 4);
+        auto r = Ltl::try_cast<nested>(lua, 1);
+        REQUIRE( r );
+        CHECK( std::get<1>(r.value).first == "foo" );
+        CHECK( std::get<2>(r.value) == 4 );
+
+        CHECK( Ltl::cast<nested>(lua, 1) == r.value );
+        CHECK( !(Ltl::try_cast<std::tuple<std::tuple<int, int>, int>>(lua, 1)) );
+    }
+
+    SECTION( "push_all" )
+    {
+        CHECK( Ltl::push_all(lua, v, std::make_pair(1, 2), 3) == 6 );
+        CHECK( lua_gettop(lua) == 9 );
     }
 }
@@ -0,0 +1,141 @@
+#include <string>
+#include <vector>
+#include "test_common.h"
+
+namespace
+{
+struct Report
+{
+    std::string name;
+    int expected;
+    int actual;
+};
+
+static std::vector<Report> reports;
+
+static void record(const char* name, int expected, int actual)
+{ reports.push_back({ name, expected, actual }); }
+
+// installs the recording handler for the duration of a test
+class Recorder
+{
+public:
+    Recorder()
+    {
+        reports.clear();
+        prev = Ltl::StackGuard::set_handler(&record);
+    }
+
+    ~Recorder()
+    { Ltl::StackGuard::set_handler(prev); }
+
+private:
+    Ltl::StackGuard::handler_t prev;
+};
+
+class Widget
+{
+public:
+    int size() const
+    { return 3; }
+};
+}
+
+TEST_CASE( "StackGuard", "[stack_guard]" )
+{
+    Vm lua;
+    Recorder recorder;
+
+#ifndef NDEBUG
+    SECTION( "balanced scope" )
+    {
+        {
+            Ltl::StackGuard guard(lua, "balanced");
+            lua_pushnil(lua);
+            lua_pop(lua, 1);
+        }
+
+        {
+            Ltl::StackGuard guard(lua, "push", 1);
+            lua_pushnil(lua);
+        }
+
+        CHECK( reports.empty() );
+    }
+
+    SECTION( "imbalance is reported" )
+    {
+        {
+            Ltl::StackGuard guard(lua, "leaky");
+            lua_pushnil(lua);
+            lua_pushnil(lua);
+        }
+
+        REQUIRE( reports.size() == 1 );
+        CHECK( reports[0].name == "leaky" );
+        CHECK( reports[0].expected == 0 );
+        CHECK( reports[0].actual == 2 );
+    }
+
+    SECTION( "not checked while an exception unwinds" )
+    {
+        try
+        {
+            Ltl::StackGuard guard(lua, "throws");
+            lua_pushnil(lua);
+            throw Ltl::TypeError(1, "int", LUA_TNIL);
+        }
+        catch ( const Ltl::TypeError& ) { }
+
+        CHECK( reports.empty() );
+    }
+
+    SECTION( "results" )
+    {
+        Ltl::StackGuard guard(lua, "results", Ltl::StackGuard::result_count);
+        lua_pushnil(lua);
+        CHECK( guard.results(1) == 1 );
+        CHECK( reports.empty() );
+
+        lua_pushnil(lua);
+        guard.results(1);
+        REQUIRE( reports.size() == 1 );
+        CHECK( reports[0].actual == 2 );
+    }
+
+    SECTION( "bindings" )
+    {
+        Ltl::register_class<Widget>(lua, "Widget")
+            .add_ctor<>()
+            .add_function("size", &Widget::size)
+            .add_function("leak", [](Ltl::Arg& arg, Widget*)
+            {
+                lua_pushnil(arg.state());
+                return 1;
+            });
+
+        // the registrar pops its tables when it is done
+        CHECK( lua_gettop(lua) == 0 );
+
+        luaL_dostring(lua, "w = Widget.new() n = w:size()");
+        CHECK( Ltl::get_global<int>(lua, "n") == 3 );
+        CHECK( reports.empty() );
+
+        luaL_dostring(lua, "w:leak()");
+        REQUIRE( reports.size() == 1 );
+        CHECK( reports[0].name == "leak" );
+        CHECK( reports[0].expected == 1 );
+        CHECK( reports[0].actual == 2 );
+    }
+#else
+    SECTION( "release builds do not check" )
+    {
+        {
+            Ltl::StackGuard guard(lua, "leaky");
+            lua_pushnil(lua);
+        }
+
+        CHECK( reports.empty() );
+    }
+#endif
+}
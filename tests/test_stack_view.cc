@@ -0,0 +1,170 @@
+#include <string>
+#include "test_common.h"
+
+namespace
+{
+class Counter
+{
+public:
+    int total = 0;
+
+    // sum the numbers after the first argument
+    int add(std::string label, Ltl::StackView rest)
+    {
+        for ( auto v : rest )
+            total += v.to<int>();
+
+        return label == "sum" ? total : rest.size();
+    }
+
+    static int count(Ltl::StackView args)
+    { return args.size(); }
+};
+}
+
+TEST_CASE( "StackView", "[stack_view]" )
+{
+    Vm lua;
+    lua_pushinteger(lua, 1);
+    lua_pushstring(lua, "two");
+    lua_pushinteger(lua, 3);
+    lua_pushboolean(lua, 1);
+
+    SECTION( "bounds are relative to bottom" )
+    {
+        Ltl::StackView view(lua, 2, 3);
+
+        CHECK( view.size() == 2 );
+        CHECK( !view.empty() );
+        CHECK( view.index(1) == 2 );
+        CHECK( view.get<std::string>(1) == "two" );
+        CHECK( view.get<int>(2) == 3 );
+        CHECK( view[2].to<int>() == 3 );
+    }
+
+    SECTION( "values beyond the view read as none" )
+    {
+        Ltl::StackView view(lua, 1, 2);
+
+        CHECK( view.get<int>(3) == 0 );
+        CHECK( view.get<int>(0) == 0 );
+        CHECK( lua_type(lua, view.index(3)) == LUA_TNONE );
+        CHECK_THROWS( view.check<int>(3) );
+    }
+
+    SECTION( "check" )
+    {
+        Ltl::StackView view(lua);
+
+        CHECK( view.size() == 4 );
+        CHECK( view.check<int>(1) == 1 );
+        CHECK( view.check<bool>(4) );
+        CHECK_THROWS( view.check<int>(2) );
+    }
+
+    SECTION( "iteration" )
+    {
+        Ltl::StackView view(lua, 1, 3);
+
+        int n = 0;
+        for ( auto v : view )
+        {
+            ++n;
+            CHECK( v.index() == n );
+        }
+
+        CHECK( n == 3 );
+
+        Ltl::StackView empty(lua, 5, 4);
+        CHECK( empty.empty() );
+        CHECK( empty.begin() == empty.end() );
+    }
+
+    SECTION( "stack API" )
+    {
+        auto view = Ltl::cast<Ltl::StackView>(lua, 2);
+        CHECK( view.bottom == 2 );
+        CHECK( view.top == 4 );
+
+        auto last = Ltl::cast<Ltl::StackView>(lua, -1);
+        CHECK( last.size() == 1 );
+
+        CHECK( Ltl::check<Ltl::StackView>(lua, 1).size() == 4 );
+        CHECK( Ltl::zero<Ltl::StackView>(lua, 1).empty() );
+        CHECK( std::string(Ltl::name<Ltl::StackView>(lua, 1)) == "StackView" );
+    }
+
+    SECTION( "scoped" )
+    {
+        {
+            Ltl::ScopedStackView scoped(Ltl::StackView(lua, 3, 4));
+            CHECK( scoped.size() == 2 );
+
+            lua_pushnil(lua);
+        }
+
+        CHECK( lua_gettop(lua) == 2 );
+    }
+}
+
+TEST_CASE( "StackView results and arguments", "[stack_view]" )
+{
+    Vm lua(true);
+
+    SECTION( "pcall results" )
+    {
+        luaL_dostring(lua, "function three() return 1, 'b', true end");
+        lua_settop(lua, 0);
+        lua_getglobal(lua, "three");
+        Ltl::Func three(lua, 1);
+
+        {
+            auto r = three.pcall<Ltl::StackView>();
+            REQUIRE( r.ok() );
+
+            Ltl::ScopedStackView results(r.value);
+            CHECK( results.bottom == 2 );
+            CHECK( results.size() == 3 );
+            CHECK( results.get<int>(1) == 1 );
+            CHECK( results.get<std::string>(2) == "b" );
+            CHECK( results.get<bool>(3) );
+            CHECK( lua_gettop(lua) == 4 );
+        }
+
+        CHECK( lua_gettop(lua) == 1 );
+
+        {
+            Ltl::ScopedStackView results(three.call<Ltl::StackView>());
+            CHECK( results.size() == 3 );
+        }
+
+        CHECK( lua_gettop(lua) == 1 );
+
+        luaL_dostring(lua, "function fail() error('x') end");
+        lua_getglobal(lua, "fail");
+        auto r = Ltl::Func(lua, -1).pcall<Ltl::StackView>();
+        CHECK( !r.ok() );
+        CHECK( r.value.empty() );
+        CHECK( lua_gettop(lua) == 2 );
+    }
+
+    SECTION( "bound function arguments" )
+    {
+        Ltl::register_class<Counter>(lua, "Counter")
+            .add_ctor<>()
+            .add_function("add", &Counter::add)
+            .add_static_function("count", &Counter::count);
+
+        luaL_dostring(lua,
+            "c = Counter.new() "
+            "n = c:add('n', 1, 2, 3) "
+            "sum = c:add('sum', 4, 5) "
+            "none = Counter.count() "
+            "all = Counter.count(1, nil, 'x')");
+
+        CHECK( Ltl::get_global<int>(lua, "n") == 3 );
+        CHECK( Ltl::get_global<int>(lua, "sum") == 15 );
+        CHECK( Ltl::get_global<int>(lua, "none") == 0 );
+        CHECK( Ltl::get_global<int>(lua, "all") == 3 );
+    }
+}
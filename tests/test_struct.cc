@@ -0,0 +1,116 @@
+#include "test_common.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct Endpoint
+{
+    uint32_t addr;
+    uint16_t port;
+};
+
+struct Flow
+{
+    Endpoint src;
+    Endpoint dst;
+    std::string proto;
+    std::vector<int> flags;
+};
+}
+
+template<>
+struct Ltl::StructDef<Endpoint> : Ltl::Fields<Endpoint, uint32_t, uint16_t>
+{
+    StructDef() : Fields({ "addr", &Endpoint::addr }, { "port", &Endpoint::port }) { }
+};
+
+template<>
+struct Ltl::StructDef<Flow> :
+    Ltl::Fields<Flow, Endpoint, Endpoint, std::string, std::vector<int>>
+{
+    StructDef() : Fields(
+        { "src", &Flow::src },
+        { "dst", &Flow::dst },
+        { "proto", &Flow::proto },
+        { "flags", &Flow::flags }) { }
+};
+
+TEST_CASE( "Stack API for structs", "[stack_api][struct]" )
+{
+    Vm lua(true);
+
+    Flow flow { { 1, 80 }, { 2, 443 }, "tcp", { 1, 2 } };
+    Ltl::push(lua, flow);
+
+    SECTION( "push" )
+    {
+        REQUIRE( lua_istable(lua, -1) );
+        lua_setglobal(lua, "flow");
+
+        REQUIRE( !luaL_dostring(lua,
+            "assert(flow.src.addr == 1 and flow.src.port == 80)\n"
+            "assert(flow.dst.port == 443 and flow.proto == 'tcp')\n"
+            "assert(#flow.flags == 2)") );
+    }
+
+    SECTION( "type" )
+    {
+        CHECK( Ltl::type<Flow>(lua, -1) );
+
+        lua_pushinteger(lua, 1);
+        CHECK( !Ltl::type<Flow>(lua, -1) );
+    }
+
+    SECTION( "cast" )
+    {
+        auto f = Ltl::cast<Flow>(lua, -1);
+        CHECK( f.src.addr == 1 );
+        CHECK( f.dst.port == 443 );
+        CHECK( f.proto == "tcp" );
+        CHECK( f.flags == flow.flags );
+
+        // missing fields are value-initialized
+        REQUIRE( !luaL_dostring(lua, "return { port = 22 }") );
+        auto e = Ltl::cast<Endpoint>(lua, -1);
+        CHECK( e.addr == 0 );
+        CHECK( e.port == 22 );
+    }
+
+    SECTION( "try_cast" )
+    {
+        auto r = Ltl::try_cast<Flow>(lua, -1);
+        CHECK( r.ok );
+        CHECK( r.value.src.port == 80 );
+
+        REQUIRE( !luaL_dostring(lua, "return { port = 22 }") );
+        CHECK( !Ltl::try_cast<Endpoint>(lua, -1) );
+
+        REQUIRE( !luaL_dostring(lua, "return { addr = 1, port = 'x' }") );
+        CHECK( !Ltl::try_cast<Endpoint>(lua, -1) );
+
+        lua_pushinteger(lua, 1);
+        CHECK( !Ltl::try_cast<Endpoint>(lua, -1) );
+    }
+
+    SECTION( "check" )
+    {
+        CHECK( Ltl::check<Flow>(lua, -1).proto == "tcp" );
+
+        lua_pushinteger(lua, 1);
+        CHECK_THROWS_AS( Ltl::check<Flow>(lua, -1), Ltl::TypeError );
+    }
+
+    SECTION( "keys are cached per state" )
+    {
+        int top = lua_gettop(lua);
+
+        Vm other;
+        Ltl::push(other, flow.src);
+        CHECK( Ltl::cast<Endpoint>(other, -1).port == 80 );
+        CHECK( Ltl::cast<Flow>(lua, -1).src.port == 80 );
+
+        CHECK( lua_gettop(lua) == top );
+    }
+}
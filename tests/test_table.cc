@@ -0,0 +1,193 @@
+#include "test_common.h"
+
+TEST_CASE( "Stack API for Table", "[stack_api][table]" )
+{
+    Vm lua;
+    lua_newtable(lua);
+
+    auto table = Ltl::Table(lua, lua_gettop(lua));
+
+    SECTION( "push" )
+    {
+        Ltl::push(lua, table);
+        CHECK( lua_rawequal(lua, -1, -2) );
+    }
+
+    SECTION( "cast" )
+    {
+        auto t = Ltl::cast<Ltl::Table>(lua, -1);
+        CHECK( t.index() == table.index() );
+    }
+
+    SECTION( "type" )
+    {
+        CHECK( Ltl::type<Ltl::Table>(lua, 0) == false );
+        CHECK( Ltl::type<Ltl::Table>(lua, 1) == true );
+        CHECK( Ltl::type<Ltl::Table>(lua, lua_gettop(lua) + 1) == false );
+    }
+
+    SECTION( "zero" )
+    {
+        auto t = Ltl::zero<Ltl::Table>(lua, -1);
+        CHECK( !t.valid() );
+    }
+
+    SECTION( "name" )
+    {
+        CHECK( std::string(Ltl::name<Ltl::Table>(lua, -1)) == "table" );
+    }
+}
+
+TEST_CASE( "Table access", "[table]" )
+{
+    Vm lua;
+    luaL_loadstring(lua, "return { 10, 20, 30, name = 'flow', [true] = 'yes' }");
+    lua_call(lua, 0, 1);
+
+    Ltl::Table table(lua, -1);
+    int top = lua_gettop(lua);
+
+    SECTION( "get" )
+    {
+        CHECK( table.get<int>(1) == 10 );
+        CHECK( table.get<int>(3u) == 30 );
+        CHECK( table.get<std::string>("name") == "flow" );
+        CHECK( table.get<std::string>(std::string("name")) == "flow" );
+        CHECK( table.get<std::string>(true) == "yes" );
+
+        // missing or mismatched values give zero<T>()
+        CHECK( table.get<int>(4) == 0 );
+        CHECK( table.get<int>("name") == 0 );
+        CHECK( lua_gettop(lua) == top );
+    }
+
+    SECTION( "set" )
+    {
+        table.set(4, 40);
+        table.set("name", "pkt");
+        table.set(2.5, true);
+
+        CHECK( table.get<int>(4) == 40 );
+        CHECK( table.get<std::string>("name") == "pkt" );
+        CHECK( table.get<bool>(2.5) );
+        CHECK( lua_gettop(lua) == top );
+    }
+
+    SECTION( "wide integer keys" )
+    {
+        const int64_t big = int64_t(1) << 40;
+
+        CHECK( table.get<int>(size_t(2)) == 20 );
+        CHECK( table.get<int>(int64_t(3)) == 30 );
+
+        // not truncated to an int
+        table.set(big + 1, 7);
+        CHECK( table.get<int>(big + 1) == 7 );
+        CHECK( table.get<int>(1) == 10 );
+
+        lua_pushnumber(lua, static_cast<lua_Number>(big + 1));
+        lua_rawget(lua, top);
+        CHECK( lua_tointeger(lua, -1) == 7 );
+        lua_pop(lua, 1);
+
+        CHECK( lua_gettop(lua) == top );
+    }
+
+    SECTION( "relative index" )
+    {
+        Ltl::Table t(lua, -1);
+
+        CHECK( t.get<int>(2) == 20 );
+        CHECK( t.get<std::string>("name") == "flow" );
+        t.set(2, 21);
+        CHECK( t.get<int>(2) == 21 );
+    }
+
+    SECTION( "raw access ignores metamethods" )
+    {
+        lua_newtable(lua);
+        Ltl::Table t(lua, -1);
+
+        luaL_loadstring(lua, "return { __index = function() return 1 end }");
+        lua_call(lua, 0, 1);
+        lua_setmetatable(lua, -2);
+
+        CHECK( t.get<int>(1) == 0 );
+    }
+
+    SECTION( "size" )
+    {
+        CHECK( table.size() == 3 );
+    }
+
+    SECTION( "iteration" )
+    {
+        int sum = 0;
+        int entries = 0;
+
+        for ( const auto& e : table )
+        {
+            ++entries;
+
+            if ( e.key.is<int>() && e.value.is<int>() )
+                sum += e.value.to<int>();
+            else if ( e.key.is<std::string>() )
+                CHECK( e.value.to<std::string>() == "flow" );
+        }
+
+        CHECK( entries == 5 );
+        CHECK( sum == 60 );
+        CHECK( lua_gettop(lua) == top );
+    }
+
+    SECTION( "typed iteration" )
+    {
+        int sum = 0;
+        int entries = 0;
+
+        for ( const auto& e : table.entries<int, int>() )
+        {
+            ++entries;
+            sum += e.key * e.value;
+        }
+
+        CHECK( entries == 3 );
+        CHECK( sum == 140 );
+
+        for ( const auto& e : table.entries<std::string, std::string>() )
+        {
+            CHECK( e.key == "name" );
+            CHECK( e.value == "flow" );
+        }
+
+        CHECK( lua_gettop(lua) == top );
+    }
+
+    SECTION( "stopping early restores the stack" )
+    {
+        for ( const auto& e : table )
+        {
+            CHECK( lua_gettop(lua) == top + 2 );
+            if ( e.key.is<int>() )
+                break;
+        }
+
+        CHECK( lua_gettop(lua) == top );
+
+        {
+            auto it = table.entries<std::string, std::string>().begin();
+            CHECK( it->value == "flow" );
+        }
+
+        CHECK( lua_gettop(lua) == top );
+    }
+
+    SECTION( "empty iteration" )
+    {
+        lua_newtable(lua);
+        Ltl::Table t(lua, -1);
+
+        CHECK( t.begin() == t.end() );
+        CHECK( lua_gettop(lua) == top + 1 );
+    }
+}
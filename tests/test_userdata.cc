@@ -58,7 +58,7 @@ TEST_CASE( "Stack API for Userdata", "[stack_api][func]" )
 
         SECTION( "name" )
         {
-            CHECK( Ltl::name<Ltl::Userdata<RegisteredType>>(lua, -1) == "Userdata<RegisteredType>" );
+            CHECK( std::string(Ltl::name<Ltl::Userdata<RegisteredType>>(lua, -1)) == "Userdata<RegisteredType>" );
         }
     }
 
@@ -96,7 +96,48 @@ TEST_CASE( "Userdata members", "[userdata]" )
          RegisteredType& udata_ref = udata;
          udata_ref.a_method();
 
+         auto r = Ltl::try_cast<Ltl::Userdata<RegisteredType>>(lua, 1);
+         REQUIRE( r.ok );
+         CHECK( static_cast<RegisteredType*>(r.value) == pm );
+         CHECK( r.value.index() == 1 );
+
          udata.invalidate();
          CHECK( !udata.valid() );
      }
 }
+
+TEST_CASE( "Userdata metatable cache", "[userdata]" )
+{
+    Vm lua;
+    register_userdata<RegisteredType>(lua, "RegisteredType");
+
+    SECTION( "type check is stack neutral" )
+    {
+        create_userdata<RegisteredType>(lua);
+        int top = lua_gettop(lua);
+
+        CHECK( Ltl::type<Ltl::Userdata<RegisteredType>>(lua, 1) );
+        CHECK( Ltl::type<Ltl::Userdata<RegisteredType>>(lua, -1) );
+        CHECK( lua_gettop(lua) == top );
+    }
+
+    SECTION( "metatable is cached on first check" )
+    {
+        create_userdata<RegisteredType>(lua);
+        CHECK( Ltl::type<Ltl::Userdata<RegisteredType>>(lua, 1) );
+
+        lua_pushlightuserdata(lua, Ltl::Userdata<RegisteredType>::metatable_key());
+        lua_rawget(lua, LUA_REGISTRYINDEX);
+        luaL_getmetatable(lua, "RegisteredType");
+        CHECK( lua_rawequal(lua, -1, -2) );
+    }
+
+    SECTION( "foreign metatable" )
+    {
+        allocate_userdata<RegisteredType>(lua);
+        lua_newtable(lua);
+        lua_setmetatable(lua, 1);
+
+        CHECK( Ltl::type<Ltl::Userdata<RegisteredType>>(lua, 1) == false );
+    }
+}
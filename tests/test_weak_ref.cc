@@ -0,0 +1,118 @@
+#include <utility>
+#include "test_common.h"
+
+namespace
+{
+static void collect(lua_State* L)
+{ lua_gc(L, LUA_GCCOLLECT, 0); }
+}
+
+TEST_CASE( "Weak references", "[weak_ref]" )
+{
+    Vm lua;
+
+    SECTION( "empty" )
+    {
+        Ltl::WeakRef ref;
+        CHECK( !ref.valid() );
+        CHECK( ref.slot() == 0 );
+
+        Ltl::WeakTable from_invalid { Ltl::Table() };
+        CHECK( !from_invalid.valid() );
+
+        // locking pushes nothing
+        CHECK( !ref.lock().valid() );
+        CHECK( !from_invalid.lock(lua).valid() );
+        CHECK( lua_gettop(lua) == 0 );
+    }
+
+    SECTION( "lock while referenced" )
+    {
+        luaL_dostring(lua, "cache = { n = 7 }");
+        lua_getglobal(lua, "cache");
+
+        Ltl::WeakTable weak { Ltl::Table(lua, 1) };
+        lua_settop(lua, 0);
+        collect(lua);
+
+        REQUIRE( weak.valid() );
+        auto t = weak.lock();
+        REQUIRE( t.valid() );
+        CHECK( t.index() == 1 );
+        CHECK( t.get<int>("n") == 7 );
+    }
+
+    SECTION( "expires once collected" )
+    {
+        lua_newtable(lua);
+        Ltl::WeakRef weak(lua, -1);
+
+        // a lock keeps the object on the stack, which keeps it alive
+        CHECK( weak.lock().valid() );
+        lua_settop(lua, 0);
+        collect(lua);
+
+        CHECK( weak.valid() );
+        CHECK( !weak.lock().valid() );
+        CHECK( lua_gettop(lua) == 0 );
+    }
+
+    SECTION( "does not keep functions alive" )
+    {
+        luaL_dostring(lua, "function on_event() end");
+        lua_getglobal(lua, "on_event");
+
+        Ltl::WeakFunc weak { Ltl::Func(lua, -1) };
+        lua_settop(lua, 0);
+
+        CHECK( weak.lock().valid() );
+        lua_settop(lua, 0);
+
+        luaL_dostring(lua, "on_event = nil");
+        collect(lua);
+        CHECK( !weak.lock().valid() );
+    }
+
+    SECTION( "slots" )
+    {
+        lua_newtable(lua);
+
+        int released;
+        {
+            Ltl::WeakRef a(lua, -1);
+            released = a.slot();
+        }
+
+        // released slots are reused
+        Ltl::WeakRef b(lua, -1);
+        CHECK( b.slot() == released );
+
+        // a slot whose object was collected stays with its reference
+        lua_newtable(lua);
+        Ltl::WeakRef c(lua, -1);
+        lua_pop(lua, 1);
+        collect(lua);
+
+        Ltl::WeakRef d(lua, -1);
+        CHECK( d.slot() != c.slot() );
+        CHECK( d.slot() != b.slot() );
+        CHECK( !c.lock().valid() );
+        CHECK( d.lock().valid() );
+    }
+
+    SECTION( "move" )
+    {
+        lua_newtable(lua);
+        Ltl::WeakRef a(lua, -1);
+        int slot = a.slot();
+
+        Ltl::WeakRef b(std::move(a));
+        CHECK( !a.valid() );
+        CHECK( b.slot() == slot );
+
+        Ltl::WeakRef c;
+        c = std::move(b);
+        CHECK( c.slot() == slot );
+        CHECK( c.lock().valid() );
+    }
+}
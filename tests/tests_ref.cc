@@ -1,3 +1,4 @@
+#include <type_traits>
 #include "test_common.h"
 
 TEST_CASE( "Stack API for Ref", "[stack_api][ref]" )
@@ -35,7 +36,7 @@ TEST_CASE( "Stack API for Ref", "[stack_api][ref]" )
 
     SECTION( "name" )
     {
-        CHECK( Ltl::name<Ltl::Ref>(lua, -1) == "Ref@1" );
+        CHECK( std::string(Ltl::name<Ltl::Ref>(lua, -1)) == "Ref" );
     }
 }
 
@@ -59,3 +60,14 @@ TEST_CASE( "Ref getters/setters", "[ref]" )
     ref.invalidate();
     CHECK( !ref.valid() );
 }
+
+TEST_CASE( "Ref handle layout", "[ref]" )
+{
+    CHECK( std::is_trivially_copyable<Ltl::Ref>::value );
+    CHECK( std::is_trivially_copyable<Ltl::Func>::value );
+    CHECK( std::is_trivially_copyable<Ltl::Table>::value );
+
+    CHECK( sizeof(Ltl::Ref) <= 16 );
+    CHECK( sizeof(Ltl::Func) <= 16 );
+    CHECK( sizeof(Ltl::Table) <= 16 );
+}